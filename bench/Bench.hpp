@@ -0,0 +1,100 @@
+#ifndef AUTOJSON_BENCH_BENCH_HPP
+#define AUTOJSON_BENCH_BENCH_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace autojson {
+namespace bench {
+
+// Number of calls to the global operator new since the program started.
+size_t AllocationCount();
+
+// Set from the command line of autojson-bench
+struct Options {
+    // only benchmarks whose name contains it are run
+    std::string filter;
+    // one JSON object per line instead of a table, to diff runs against each other
+    bool json = false;
+    double minSeconds = 0.5;
+};
+
+Options& GetOptions();
+
+struct Measurement {
+    std::string name;
+    long long iterations;
+    double nsPerOp;
+    double allocationsPerOp;
+    double megabytesPerSecond;
+};
+
+// Runs op until at least minSeconds have passed and reports the average cost of one call.
+// bytesPerOp is only used to compute the throughput and can be 0.
+// Benchmarks left out by the filter are not run and have no iterations.
+Measurement Measure(const std::string &name, size_t bytesPerOp, const std::function<void()> &op);
+
+// Prints the measurement, unless it was not run
+void Report(const Measurement &measurement);
+
+// Prints a size that is not timed, like the bytes of an encoding
+void ReportSize(const std::string &name, size_t bytes);
+
+// Keeps the optimizer from throwing away a computed value.
+template<typename T>
+inline void DoNotOptimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Many small scalars: the shape of the payloads the node layout is tuned for.
+std::string ScalarHeavyDocument(int records);
+
+// Log-like records with long strings, escapes and nested objects, closer to the telemetry
+// files the structural index is meant for.
+std::string TelemetryDocument(int records);
+
+// Prose with escapes: parsing and writing are dominated by copying text
+std::string StringHeavyDocument(int records);
+
+// chains values nested depth levels deep, objects and arrays in turn
+std::string DeepDocument(int chains, int depth);
+
+// One object with keys entries
+std::string WideObjectDocument(int keys);
+
+// The corpora above and TelemetryDocument by name, a few MB each. They are generated the
+// same way on every run, so numbers can be compared between releases.
+std::vector<std::pair<std::string, std::string>> Corpora();
+
+void RunParseBenchmarks();
+
+void RunWriteBenchmarks();
+
+void RunObjectBenchmarks();
+
+// Generated class writers against building a JSON first
+void RunSerializeBenchmarks();
+
+// Each op formats 1000 numbers
+void RunFormatBenchmarks();
+
+// autojson-bin over headers with more and more classes
+void RunCodegenBenchmarks();
+
+// Size and speed of CBOR and MessagePack against JSON text
+void RunBinaryBenchmarks();
+
+// Opening a snapshot against reading and parsing the same file, and frozen documents read
+// by more and more threads
+void RunSnapshotBenchmarks();
+
+// NDJSON split and parsed by hand against JSONLinesReader, with one and with all cores
+void RunLinesBenchmarks();
+
+}  // namespace bench
+}  // namespace autojson
+
+#endif // AUTOJSON_BENCH_BENCH_HPP
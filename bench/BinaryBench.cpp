@@ -0,0 +1,98 @@
+#include "Bench.hpp"
+
+#include <string>
+
+#include "Binary.hpp"
+#include "Handler.hpp"
+#include "JSON.hpp"
+
+namespace autojson {
+namespace bench {
+
+namespace {
+
+// Counts the scalars, so decoding is measured without building anything
+class ScalarCount : public JSONHandler {
+public:
+    long long count = 0;
+
+    bool string(const char*, size_t) override { this->count += 1; return true; }
+    bool integer(long long) override { this->count += 1; return true; }
+    bool real(double) override { this->count += 1; return true; }
+    bool boolean(bool) override { this->count += 1; return true; }
+};
+
+void RunPayload(const std::string &name, const std::string &text) {
+    const JSON doc = JSON::parse(text);
+    const std::string compact = doc.stringify();
+    const std::string cbor = doc.toCBOR();
+    const std::string messagePack = doc.toMessagePack();
+
+    ReportSize("size/" + name + "/json", compact.size());
+    ReportSize("size/" + name + "/cbor", cbor.size());
+    ReportSize("size/" + name + "/msgpack", messagePack.size());
+
+    std::string out;
+    Report(Measure("encode/" + name + "/json", compact.size(), [&]() {
+        out.clear();
+        doc.stringify(out);
+        DoNotOptimize(out);
+    }));
+
+    Report(Measure("encode/" + name + "/cbor", cbor.size(), [&]() {
+        out.clear();
+        doc.toCBOR(out);
+        DoNotOptimize(out);
+    }));
+
+    Report(Measure("encode/" + name + "/msgpack", messagePack.size(), [&]() {
+        out.clear();
+        doc.toMessagePack(out);
+        DoNotOptimize(out);
+    }));
+
+    Report(Measure("decode/" + name + "/json", compact.size(), [&]() {
+        JSON j = JSON::parse(compact);
+        DoNotOptimize(j);
+    }));
+
+    Report(Measure("decode/" + name + "/cbor", cbor.size(), [&]() {
+        JSON j = JSON::fromCBOR(cbor);
+        DoNotOptimize(j);
+    }));
+
+    Report(Measure("decode/" + name + "/msgpack", messagePack.size(), [&]() {
+        JSON j = JSON::fromMessagePack(messagePack);
+        DoNotOptimize(j);
+    }));
+
+    Report(Measure("events/" + name + "/json", compact.size(), [&]() {
+        ScalarCount handler;
+        ParseEvents(compact, handler);
+        DoNotOptimize(handler.count);
+    }));
+
+    Report(Measure("events/" + name + "/cbor", cbor.size(), [&]() {
+        ScalarCount handler;
+        const char *data = cbor.data();
+        ParseBinaryEvents(data, data + cbor.size(), CBOR, handler);
+        DoNotOptimize(handler.count);
+    }));
+
+    Report(Measure("events/" + name + "/msgpack", messagePack.size(), [&]() {
+        ScalarCount handler;
+        const char *data = messagePack.data();
+        ParseBinaryEvents(data, data + messagePack.size(), MESSAGE_PACK, handler);
+        DoNotOptimize(handler.count);
+    }));
+}
+
+}  // namespace
+
+void RunBinaryBenchmarks() {
+    RunPayload("scalar-heavy", ScalarHeavyDocument(2000));
+    RunPayload("telemetry", TelemetryDocument(20000));
+}
+
+}  // namespace bench
+}  // namespace autojson
@@ -0,0 +1,117 @@
+#include "Bench.hpp"
+
+#include <string>
+#include <vector>
+
+#include "../bin/CodeGenerator.hpp"
+#include "../bin/Parse.hpp"
+#include "CodegenCorpusJSONImpl.hpp"
+
+namespace autojson {
+namespace bench {
+
+namespace {
+
+// numClasses classes that use each other, with a nested class each. CodegenCorpus.hpp holds
+// the first four, keep both the same.
+std::string MakeCorpus(int numClasses) {
+    std::string corpus = "#include <map>\n#include <string>\n#include <vector>\n\nnamespace corpus {\n";
+    for (int i = 0; i < numClasses; i += 1) {
+        std::string name = "Class" + std::to_string(i);
+        corpus +=
+            "// " + name + " stores some things\n"
+            "struct " + name + " {\n"
+            "    struct Inner" + std::to_string(i) + " {\n"
+            "        int value;\n"
+            "        std::string label;\n"
+            "    };\n\n"
+            "    int id_number;\n"
+            "    std::string display_name;\n"
+            "    /* the one before */\n"
+            "    Class" + std::to_string(i / 2) + " *parent;\n"
+            "    std::vector<Class" + std::to_string(i / 3) + "> children;\n"
+            "    std::map<std::string, " + name + "::Inner" + std::to_string(i) + "> by_label;\n"
+            "    double score, weight;\n"
+            "};\n\n";
+    }
+    return corpus + "}\n";
+}
+
+// What autojson-bin does for one header, without the file system
+size_t Generate(const std::string &content) {
+    auto text = EraseComments(content);
+    auto words = GetWords(text);
+    ClassBundle cb = ParseClasses(words);
+    cb.upgradeScopes();
+
+    size_t size = 0;
+    for (const auto &itr : cb.allClasses) {
+        size += JSONWriterClass(itr, false).size();
+        size += JSONReaderClass(itr).size();
+        size += JSONifyClass(itr).size();
+    }
+    return size;
+}
+
+// A Class3 with a parent and children, which each have labels, for the generated code to go through
+corpus::Class3 MakeRecord(int children) {
+    corpus::Class3 record{};
+    record.id_number = 3;
+    record.display_name = "record";
+    record.parent = new corpus::Class1{};
+    record.parent->id_number = 1;
+    for (int i = 0; i < children; i += 1) {
+        corpus::Class1 child{};
+        child.id_number = i;
+        child.display_name = "child " + std::to_string(i);
+        child.by_label["label " + std::to_string(i)] = {i, "inner"};
+        child.score = i * 0.5;
+        record.children.push_back(child);
+    }
+    return record;
+}
+
+}  // namespace
+
+void RunCodegenBenchmarks() {
+    // the code autojson-bin generated for CodegenCorpus.hpp, compiled by the build
+    const corpus::Class3 record = MakeRecord(1000);
+    std::string text;
+    {
+        JSONWriter writer(text);
+        write(writer, record);
+    }
+    Report(Measure("codegen/generated/write", text.size(), [&]() {
+        std::string out;
+        JSONWriter writer(out);
+        write(writer, record);
+        DoNotOptimize(out);
+    }));
+
+    corpus::Class3 result{};
+    Report(Measure("codegen/generated/read", text.size(), [&]() {
+        ParseInto(text, result);
+        DoNotOptimize(result);
+    }));
+    delete record.parent;
+    delete result.parent;
+
+    // linear when the time per class stays the same as the header grows
+    for (int numClasses : {1000, 2000, 4000}) {
+        const std::string corpus = MakeCorpus(numClasses);
+        Measurement m = Measure("codegen/" + std::to_string(numClasses) + "-classes", corpus.size(), [&]() {
+            DoNotOptimize(Generate(corpus));
+        });
+        Report(m);
+
+        Measurement perClass = m;
+        perClass.name += "/per-class";
+        perClass.nsPerOp /= numClasses;
+        perClass.allocationsPerOp /= numClasses;
+        perClass.megabytesPerSecond = 0;
+        Report(perClass);
+    }
+}
+
+}  // namespace bench
+}  // namespace autojson
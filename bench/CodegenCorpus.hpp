@@ -0,0 +1,75 @@
+#ifndef AUTOJSON_BENCH_CODEGEN_CORPUS_HPP
+#define AUTOJSON_BENCH_CODEGEN_CORPUS_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+
+// The first classes of the corpus CodegenBench.cpp generates, written out. The build runs
+// autojson-bin over this header and CodegenBench.cpp includes the result, so every kind of
+// field in the corpus also goes through the generated code.
+namespace corpus {
+
+struct Class0 {
+    struct Inner0 {
+        int value;
+        std::string label;
+    };
+
+    int id_number;
+    std::string display_name;
+    /* the one before */
+    Class0 *parent;
+    std::vector<Class0> children;
+    std::map<std::string, Class0::Inner0> by_label;
+    double score, weight;
+};
+
+struct Class1 {
+    struct Inner1 {
+        int value;
+        std::string label;
+    };
+
+    int id_number;
+    std::string display_name;
+    /* the one before */
+    Class0 *parent;
+    std::vector<Class0> children;
+    std::map<std::string, Class1::Inner1> by_label;
+    double score, weight;
+};
+
+struct Class2 {
+    struct Inner2 {
+        int value;
+        std::string label;
+    };
+
+    int id_number;
+    std::string display_name;
+    /* the one before */
+    Class1 *parent;
+    std::vector<Class0> children;
+    std::map<std::string, Class2::Inner2> by_label;
+    double score, weight;
+};
+
+struct Class3 {
+    struct Inner3 {
+        int value;
+        std::string label;
+    };
+
+    int id_number;
+    std::string display_name;
+    /* the one before */
+    Class1 *parent;
+    std::vector<Class1> children;
+    std::map<std::string, Class3::Inner3> by_label;
+    double score, weight;
+};
+
+}  // namespace corpus
+
+#endif // AUTOJSON_BENCH_CODEGEN_CORPUS_HPP
@@ -0,0 +1,68 @@
+#include "Bench.hpp"
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Format.hpp"
+
+namespace autojson {
+namespace bench {
+
+void RunFormatBenchmarks() {
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<double> coordinates(-180, 180);
+    std::vector<double> reals(1000);
+    std::vector<long long> integers(1000);
+    for (size_t i = 0; i < reals.size(); i += 1) {
+        reals[i] = coordinates(random);
+        integers[i] = (long long)(random() >> (random() % 64));
+    }
+
+    Report(Measure("format/real/to_string", 0, [&]() {
+        size_t size = 0;
+        for (double value : reals) {
+            size += std::to_string(value).size();
+        }
+        DoNotOptimize(size);
+    }));
+
+    Report(Measure("format/real/snprintf-17g", 0, [&]() {
+        char buffer[kMaxNumberLength];
+        size_t size = 0;
+        for (double value : reals) {
+            size += snprintf(buffer, sizeof(buffer), "%.17g", value);
+        }
+        DoNotOptimize(size);
+    }));
+
+    Report(Measure("format/real/shortest", 0, [&]() {
+        char buffer[kMaxNumberLength];
+        size_t size = 0;
+        for (double value : reals) {
+            size += FormatReal(value, buffer);
+        }
+        DoNotOptimize(size);
+    }));
+
+    Report(Measure("format/integer/to_string", 0, [&]() {
+        size_t size = 0;
+        for (long long value : integers) {
+            size += std::to_string(value).size();
+        }
+        DoNotOptimize(size);
+    }));
+
+    Report(Measure("format/integer/FormatInteger", 0, [&]() {
+        char buffer[kMaxNumberLength];
+        size_t size = 0;
+        for (long long value : integers) {
+            size += FormatInteger(value, buffer);
+        }
+        DoNotOptimize(size);
+    }));
+}
+
+}  // namespace bench
+}  // namespace autojson
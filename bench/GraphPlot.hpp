@@ -0,0 +1,29 @@
+#ifndef AUTOJSON_BENCH_GRAPH_PLOT_HPP
+#define AUTOJSON_BENCH_GRAPH_PLOT_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Same classes as examples/graph_plot/graph_plot.h. The build runs autojson-bin over this
+// header, and SerializeBench.cpp includes the GraphPlotJSONImpl.hpp it generates.
+struct GraphPlot {
+    struct Node {
+        int x_pos;
+        int y_pos;
+    };
+
+    struct Edge {
+        std::string source;
+        std::string target;
+        int is_directed;
+    };
+
+    int x_size;
+    int y_size;
+
+    std::vector<Edge> all_edges;
+    std::map<std::string, Node> node_info;
+};
+
+#endif // AUTOJSON_BENCH_GRAPH_PLOT_HPP
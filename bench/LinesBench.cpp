@@ -0,0 +1,75 @@
+#include "Bench.hpp"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "JSON.hpp"
+#include "Lines.hpp"
+#include "Writer.hpp"
+
+namespace autojson {
+namespace bench {
+
+void RunLinesBenchmarks() {
+    const std::vector<JSON> records = JSON::parse(TelemetryDocument(100000));
+    std::string text;
+    JSONLinesWriter(text, 1).write(records);
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+    // what callers do without JSONLinesReader: split by hand and parse every line
+    Report(Measure("ndjson/telemetry/split-and-parse", text.size(), [&]() {
+        long long sum = 0;
+        std::string line;
+        for (size_t begin = 0; begin < text.size(); ) {
+            size_t end = text.find('\n', begin);
+            end = end == std::string::npos ? text.size() : end;
+            line.assign(text, begin, end - begin);
+            sum += (long long)JSON::parse(line)["metrics"]["rss"];
+            begin = end + 1;
+        }
+        DoNotOptimize(sum);
+    }));
+
+    std::vector<unsigned> jobCounts = {1};
+    if (cores > 1) {
+        jobCounts.push_back(cores);
+    }
+    for (unsigned jobs : jobCounts) {
+        for (JSONLinesOrder order : {INPUT_ORDER, ANY_ORDER}) {
+            std::string name = "ndjson/telemetry/reader-" + std::to_string(jobs) + (order == INPUT_ORDER ? "/ordered" : "/unordered");
+            Report(Measure(name, text.size(), [&]() {
+                JSONLinesReader reader(jobs);
+                reader.open(text.data(), text.size());
+                long long sum = 0;
+                reader.read([&sum](size_t, JSON &record) {
+                    sum += (long long)record["metrics"]["rss"];
+                    return true;
+                }, order);
+                DoNotOptimize(sum);
+            }));
+        }
+    }
+
+    std::string out;
+    Report(Measure("ndjson/telemetry/write-serial", text.size(), [&]() {
+        out.clear();
+        JSONWriter writer(out);
+        for (const JSON &record : records) {
+            writer.write(record);
+            out += '\n';
+        }
+        DoNotOptimize(out);
+    }));
+
+    JSONLinesWriter writer(out, cores);
+    Report(Measure("ndjson/telemetry/writer-" + std::to_string(cores), text.size(), [&]() {
+        out.clear();
+        writer.write(records);
+        DoNotOptimize(out);
+    }));
+}
+
+}  // namespace bench
+}  // namespace autojson
@@ -0,0 +1,171 @@
+#include "Bench.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "Writer.hpp"
+
+namespace {
+
+std::atomic<size_t> allocationCount(0);
+
+void* CountedAllocation(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+    return CountedAllocation(size);
+}
+
+void* operator new[](size_t size) {
+    return CountedAllocation(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace autojson {
+namespace bench {
+
+size_t AllocationCount() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+Options& GetOptions() {
+    static Options options;
+    return options;
+}
+
+Measurement Measure(const std::string &name, size_t bytesPerOp, const std::function<void()> &op) {
+    typedef std::chrono::steady_clock Clock;
+
+    Measurement m;
+    m.name = name;
+    m.iterations = 0;
+    if (name.find(GetOptions().filter) == std::string::npos) {
+        return m;
+    }
+
+    // warm up caches and the allocator
+    op();
+
+    long long iterations = 0;
+    size_t allocationsBefore = AllocationCount();
+    auto start = Clock::now();
+    double elapsed = 0;
+    do {
+        op();
+        iterations += 1;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < GetOptions().minSeconds);
+    size_t allocations = AllocationCount() - allocationsBefore;
+
+    m.iterations = iterations;
+    m.nsPerOp = elapsed * 1e9 / iterations;
+    m.allocationsPerOp = double(allocations) / iterations;
+    m.megabytesPerSecond = bytesPerOp ? (double(bytesPerOp) * iterations / elapsed) / (1024.0 * 1024.0) : 0;
+    return m;
+}
+
+void Report(const Measurement &m) {
+    if (m.iterations == 0) {
+        return;
+    }
+
+    if (not GetOptions().json) {
+        std::printf("%-40s %12.1f ns/op %12.1f allocs/op %10.1f MB/s\n", m.name.c_str(), m.nsPerOp, m.allocationsPerOp, m.megabytesPerSecond);
+        return;
+    }
+
+    std::string line;
+    JSONWriter writer(line);
+    writer.startObject();
+    writer.key("name", 4);
+    writer.string(m.name.data(), m.name.size());
+    writer.key("iterations", 10);
+    writer.integer(m.iterations);
+    writer.key("nsPerOp", 7);
+    writer.real(m.nsPerOp);
+    writer.key("allocsPerOp", 11);
+    writer.real(m.allocationsPerOp);
+    writer.key("mbPerSecond", 11);
+    writer.real(m.megabytesPerSecond);
+    writer.endObject();
+    line += '\n';
+    std::fwrite(line.data(), 1, line.size(), stdout);
+}
+
+void ReportSize(const std::string &name, size_t bytes) {
+    if (name.find(GetOptions().filter) == std::string::npos) {
+        return;
+    }
+
+    if (not GetOptions().json) {
+        std::printf("%-40s %12zu bytes\n", name.c_str(), bytes);
+        return;
+    }
+
+    std::string line;
+    JSONWriter writer(line);
+    writer.startObject();
+    writer.key("name", 4);
+    writer.string(name.data(), name.size());
+    writer.key("bytes", 5);
+    writer.unsignedInteger(bytes);
+    writer.endObject();
+    line += '\n';
+    std::fwrite(line.data(), 1, line.size(), stdout);
+}
+
+}  // namespace bench
+}  // namespace autojson
+
+int main(int argc, char** argv) {
+    autojson::bench::Options &options = autojson::bench::GetOptions();
+    for (int i = 1; i < argc; i += 1) {
+        if (strcmp(argv[i], "--json") == 0) {
+            options.json = true;
+        } else if (strcmp(argv[i], "--filter") == 0 and i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (strcmp(argv[i], "--min-time") == 0 and i + 1 < argc) {
+            options.minSeconds = std::atof(argv[++i]);
+        } else {
+            std::fprintf(stderr, "usage: %s [--json] [--filter TEXT] [--min-time SECONDS]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    autojson::bench::RunParseBenchmarks();
+    autojson::bench::RunWriteBenchmarks();
+    autojson::bench::RunObjectBenchmarks();
+    autojson::bench::RunSerializeBenchmarks();
+    autojson::bench::RunFormatBenchmarks();
+    autojson::bench::RunCodegenBenchmarks();
+    autojson::bench::RunBinaryBenchmarks();
+    autojson::bench::RunSnapshotBenchmarks();
+    autojson::bench::RunLinesBenchmarks();
+}
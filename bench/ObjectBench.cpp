@@ -0,0 +1,169 @@
+#include "Bench.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "JSON.hpp"
+
+namespace autojson {
+namespace bench {
+
+namespace {
+
+std::vector<std::string> FieldNames(int count) {
+    std::vector<std::string> names;
+    for (int i = 0; i < count; i += 1) {
+        names.push_back("field_" + std::to_string(i * 7919 % 1000));
+    }
+    return names;
+}
+
+void LookupBenchmark(int keys) {
+    const std::vector<std::string> names = FieldNames(keys);
+    JSON object(JSONType::OBJECT);
+    for (size_t i = 0; i < names.size(); i += 1) {
+        object[names[i]] = (int)i;
+    }
+
+    const JSON &view = object;
+    Report(Measure("object/lookup/" + std::to_string(keys) + "-keys", 0, [&]() {
+        long long sum = 0;
+        for (const std::string &name : names) {
+            sum += (int)view[name.c_str()];
+        }
+        DoNotOptimize(sum);
+    }));
+
+    std::vector<JSON::Key> handles;
+    for (const std::string &name : names) {
+        handles.emplace_back(name);
+    }
+    Report(Measure("object/lookup/" + std::to_string(keys) + "-keys/handle", 0, [&]() {
+        long long sum = 0;
+        for (const JSON::Key &key : handles) {
+            sum += (int)view[key];
+        }
+        DoNotOptimize(sum);
+    }));
+}
+
+// Adds keys one at a time with operator[], in ascending, descending or shuffled order of the
+// sorted keys, then reads the object once so keys kept aside are sorted in too
+void BuildBenchmark(int keys) {
+    std::vector<std::string> ascending;
+    for (int i = 0; i < keys; i += 1) {
+        std::string number = std::to_string(i);
+        ascending.push_back("key_" + std::string(8 - number.size(), '0') + number);
+    }
+    std::vector<std::string> descending(ascending.rbegin(), ascending.rend());
+    std::vector<std::string> shuffled = ascending;
+    for (size_t i = 0; i < shuffled.size(); i += 1) {
+        std::swap(shuffled[i], shuffled[i * 7919 % shuffled.size()]);
+    }
+
+    const std::pair<const char*, const std::vector<std::string>*> orders[] = {
+        {"ascending", &ascending},
+        {"descending", &descending},
+        {"shuffled", &shuffled}
+    };
+    for (const auto &order : orders) {
+        const std::vector<std::string> &names = *order.second;
+        Report(Measure("object/build/" + std::to_string(keys) + "-keys/operator[]/" + order.first, 0, [&]() {
+            JSON object;
+            for (size_t i = 0; i < names.size(); i += 1) {
+                object[names[i]] = (int)i;
+            }
+            const JSON &view = object;
+            DoNotOptimize(view.find(names[0]));
+        }));
+    }
+}
+
+// Reads three values four levels down, the way configuration is usually read
+void DeepLookupBenchmark() {
+    JSON config = JSON::parse(
+        "{\"service\": {\"name\": \"api\", \"replicas\": 3},"
+        " \"config\": {\"limits\": {\"rps\": 1000, \"burst\": 50, \"tiers\": [10, 100, 1000]},"
+        "              \"timeouts\": {\"read\": 5, \"write\": 10}}}");
+    const JSON &view = config;
+
+    Report(Measure("object/deep-lookup/operator[]", 0, [&]() {
+        long long sum = (int)view["config"]["limits"]["rps"];
+        sum += (int)view["config"]["limits"]["tiers"][2];
+        sum += (int)view["config"]["timeouts"]["write"];
+        DoNotOptimize(sum);
+    }));
+
+    const JSON::Path rps("/config/limits/rps");
+    const JSON::Path tier("/config/limits/tiers/2");
+    const JSON::Path write("/config/timeouts/write");
+    Report(Measure("object/deep-lookup/path", 0, [&]() {
+        long long sum = (int)*view.find(rps);
+        sum += (int)*view.find(tier);
+        sum += (int)*view.find(write);
+        DoNotOptimize(sum);
+    }));
+}
+
+}  // namespace
+
+void RunObjectBenchmarks() {
+    LookupBenchmark(8);
+    LookupBenchmark(24);
+    LookupBenchmark(200);
+    DeepLookupBenchmark();
+
+    const std::vector<std::string> names = FieldNames(24);
+    Report(Measure("object/build/24-keys", 0, [&]() {
+        JSON object;
+        for (size_t i = 0; i < names.size(); i += 1) {
+            object[names[i]] = (int)i;
+        }
+        DoNotOptimize(object);
+    }));
+
+    BuildBenchmark(40000);
+
+    Report(Measure("object/build/initializer-list", 0, [&]() {
+        JSON object = {
+            {"id", 1},
+            {"name", "autojson"},
+            {"score", 0.5},
+            {"active", true},
+            {"tags", {"github", "json", "c++"}},
+            {"owner", {{"login", "establishment"}, {"id", 42}}}
+        };
+        DoNotOptimize(object);
+    }));
+
+    JSON records(JSONType::VECTOR);
+    for (int i = 0; i < 100; i += 1) {
+        JSON record;
+        for (size_t j = 0; j < names.size(); j += 1) {
+            record[names[j]] = "value of " + names[j] + " in record " + std::to_string(i);
+        }
+        records.push_back(record);
+    }
+
+    Report(Measure("object/copy/100-records", 0, [&]() {
+        JSON copy = records;
+        DoNotOptimize(copy);
+    }));
+
+    JSON shared = records;
+    shared.share();
+    Report(Measure("object/copy/100-records/shared", 0, [&]() {
+        JSON copy = shared;
+        DoNotOptimize(copy);
+    }));
+
+    Report(Measure("object/copy/100-records/shared-then-write", 0, [&]() {
+        JSON copy = shared;
+        copy[50][names[0]] = 0;
+        DoNotOptimize(copy);
+    }));
+}
+
+}  // namespace bench
+}  // namespace autojson
@@ -0,0 +1,275 @@
+#include "Bench.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Document.hpp"
+#include "Handler.hpp"
+#include "JSON.hpp"
+#include "OnDemand.hpp"
+#include "Push.hpp"
+#include "StructuralIndex.hpp"
+
+namespace autojson {
+namespace bench {
+
+std::string ScalarHeavyDocument(int records) {
+    std::string doc = "[";
+    for (int i = 0; i < records; i += 1) {
+        if (i) {
+            doc += ",";
+        }
+        doc += "{\"id\":" + std::to_string(i) +
+               ",\"score\":" + std::to_string(i % 100) + "." + std::to_string(i % 7) +
+               ",\"active\":" + (i % 2 ? "true" : "false") +
+               ",\"name\":\"user" + std::to_string(i) + "\"" +
+               ",\"tags\":[\"a\",\"bb\",\"ccc\"]}";
+    }
+    doc += "]";
+    return doc;
+}
+
+std::string TelemetryDocument(int records) {
+    std::string doc = "[\n";
+    for (int i = 0; i < records; i += 1) {
+        if (i) {
+            doc += ",\n";
+        }
+        doc += "  {\"timestamp\": " + std::to_string(1500000000000LL + i * 37) +
+               ", \"host\": \"worker-" + std::to_string(i % 64) + ".cluster.internal\"" +
+               ", \"level\": \"" + (i % 10 ? "info" : "warning") + "\"" +
+               ", \"message\": \"request finished in " + std::to_string(i % 997) + "ms for \\\"/api/v2/items\\\"\"" +
+               ", \"metrics\": {\"cpu\": 0." + std::to_string(i % 89) + ", \"rss\": " + std::to_string(1000000 + i) + "}" +
+               ", \"labels\": [\"region-eu\", \"tier-backend\", \"canary\"]}";
+    }
+    doc += "\n]\n";
+    return doc;
+}
+
+std::string StringHeavyDocument(int records) {
+    std::string doc = "[";
+    for (int i = 0; i < records; i += 1) {
+        if (i) {
+            doc += ",";
+        }
+        doc += "{\"title\":\"Release notes for build " + std::to_string(i) + " of the storage service\"" +
+               ",\"body\":\"Fixed \\\"" + std::to_string(i % 31) + "\\\" crashes when the cache was cold;\\n" +
+               "compaction now runs in the background and no longer blocks writers for more than a few milliseconds.\"" +
+               ",\"author\":\"engineer-" + std::to_string(i % 97) + "@example.com\"}";
+    }
+    doc += "]";
+    return doc;
+}
+
+std::string DeepDocument(int chains, int depth) {
+    std::string doc = "[";
+    for (int i = 0; i < chains; i += 1) {
+        if (i) {
+            doc += ",";
+        }
+        // objects and arrays in turn, depth levels down
+        for (int level = 0; level < depth; level += 1) {
+            doc += level % 2 ? "[" : "{\"level\":" + std::to_string(level) + ",\"next\":";
+        }
+        doc += std::to_string(i);
+        for (int level = depth - 1; level >= 0; level -= 1) {
+            doc += level % 2 ? "]" : "}";
+        }
+    }
+    doc += "]";
+    return doc;
+}
+
+std::string WideObjectDocument(int keys) {
+    std::string doc = "{";
+    for (int i = 0; i < keys; i += 1) {
+        if (i) {
+            doc += ",";
+        }
+        doc += "\"key_" + std::to_string(i * 7919 % keys) + "_" + std::to_string(i) + "\":" + std::to_string(i);
+    }
+    doc += "}";
+    return doc;
+}
+
+std::vector<std::pair<std::string, std::string>> Corpora() {
+    return {
+        {"numbers", ScalarHeavyDocument(20000)},
+        {"strings", StringHeavyDocument(10000)},
+        {"deep", DeepDocument(2000, 64)},
+        {"wide", WideObjectDocument(50000)},
+        {"telemetry", TelemetryDocument(10000)},
+    };
+}
+
+namespace {
+
+// About 200KB: a few small fields around a large batch nobody reads
+std::string RequestDocument() {
+    std::string doc = "{\"id\": 7, \"user\": {\"name\": \"ann\", \"roles\": [\"admin\", \"dev\"]}, \"events\": ";
+    doc += TelemetryDocument(700);
+    doc += ", \"status\": \"ok\"}";
+    return doc;
+}
+
+// Sums metrics.rss over all records, the kind of job that only needs a few fields
+class RssSum : public JSONHandler {
+public:
+    long long sum = 0;
+
+    bool key(const char *data, size_t size) override {
+        this->inRss = (size == 3 and memcmp(data, "rss", 3) == 0);
+        return true;
+    }
+
+    bool integer(long long value) override {
+        if (this->inRss) {
+            this->sum += value;
+        }
+        return true;
+    }
+
+private:
+    bool inRss = false;
+};
+
+}  // namespace
+
+void RunParseBenchmarks() {
+    const std::string doc = ScalarHeavyDocument(2000);
+
+    Report(Measure("parse/scalar-heavy", doc.size(), [&]() {
+        JSON j = JSON::parse(doc);
+        DoNotOptimize(j);
+    }));
+
+    JSONDocument document;
+    Report(Measure("parse/scalar-heavy/arena", doc.size(), [&]() {
+        const JSON& j = document.parse(doc);
+        DoNotOptimize(j);
+    }));
+
+    for (const auto &corpus : Corpora()) {
+        Report(Measure("parse/corpus/" + corpus.first, corpus.second.size(), [&]() {
+            JSON j = JSON::parse(corpus.second);
+            DoNotOptimize(j);
+        }));
+    }
+
+    const std::string telemetry = TelemetryDocument(100000);
+
+    Report(Measure("parse/telemetry", telemetry.size(), [&]() {
+        JSON j = JSON::parse(telemetry);
+        DoNotOptimize(j);
+    }));
+
+    Report(Measure("parse/telemetry/indexed", telemetry.size(), [&]() {
+        JSON j = JSON::parseIndexed(telemetry);
+        DoNotOptimize(j);
+    }));
+
+    Report(Measure("parse/telemetry/indexed/arena", telemetry.size(), [&]() {
+        const JSON& j = document.parseIndexed(telemetry);
+        DoNotOptimize(j);
+    }));
+
+    Report(Measure("parse/telemetry/try", telemetry.size(), [&]() {
+        ParseResult result;
+        JSON j = JSON::tryParse(telemetry, result);
+        DoNotOptimize(j);
+    }));
+
+    Report(Measure("parse/telemetry/try/arena", telemetry.size(), [&]() {
+        ParseResult result;
+        const JSON& j = document.tryParse(telemetry, result);
+        DoNotOptimize(j);
+    }));
+
+    Report(Measure("aggregate/telemetry/tree", telemetry.size(), [&]() {
+        JSON j = JSON::parse(telemetry);
+        long long sum = 0;
+        for (auto& record : j) {
+            sum += (long long)record["metrics"]["rss"];
+        }
+        DoNotOptimize(sum);
+    }));
+
+    Report(Measure("aggregate/telemetry/events", telemetry.size(), [&]() {
+        RssSum handler;
+        ParseEvents(telemetry, handler);
+        DoNotOptimize(handler.sum);
+    }));
+
+    // the body arriving in 16KB pieces, as from a socket
+    const size_t kPieceSize = 16 * 1024;
+    std::string body;
+    Report(Measure("chunked/telemetry/concatenate-and-parse", telemetry.size(), [&]() {
+        body.clear();
+        for (size_t i = 0; i < telemetry.size(); i += kPieceSize) {
+            body.append(telemetry, i, kPieceSize);
+        }
+        JSON j = JSON::parse(body);
+        DoNotOptimize(j);
+    }));
+
+    JSONPushParser push;
+    Report(Measure("chunked/telemetry/push", telemetry.size(), [&]() {
+        push.reset();
+        for (size_t i = 0; i < telemetry.size(); i += kPieceSize) {
+            push.feed(telemetry.data() + i, std::min(kPieceSize, telemetry.size() - i));
+        }
+        JSON j = push.result();
+        DoNotOptimize(j);
+    }));
+
+    const std::string request = RequestDocument();
+
+    Report(Measure("ondemand/3-fields/parse", request.size(), [&]() {
+        JSON j = JSON::parse(request);
+        long long id = j["id"];
+        std::string name = j["user"]["name"];
+        std::string status = j["status"];
+        DoNotOptimize(id);
+        DoNotOptimize(name);
+        DoNotOptimize(status);
+    }));
+
+    Report(Measure("ondemand/3-fields/lazy", request.size(), [&]() {
+        JSONLazyDocument lazy(request);
+        JSONLazyObject root = lazy.root().object();
+        long long id = root.find("id");
+        std::string name = root.find("user")["name"];
+        std::string status = root.find("status");
+        DoNotOptimize(id);
+        DoNotOptimize(name);
+        DoNotOptimize(status);
+    }));
+
+    // stage 1 alone, once per kernel the machine supports
+    std::vector<uint32_t> index;
+    for (int kernel = SCALAR_KERNEL; kernel <= DetectStructuralKernel(); kernel += 1) {
+        std::string name = std::string("index/telemetry/") + StructuralKernelToString((StructuralKernel)kernel);
+        Report(Measure(name, telemetry.size(), [&]() {
+            index.clear();
+            BuildStructuralIndex(telemetry.data(), telemetry.size(), index, (StructuralKernel)kernel);
+            DoNotOptimize(index.data());
+        }));
+    }
+
+    JSON parsed = JSON::parse(doc);
+    Report(Measure("convert/read-numbers", 0, [&]() {
+        double sum = 0;
+        for (auto& record : parsed) {
+            sum += (int)record["id"];
+            sum += (double)record["score"];
+            sum += record["score"].isReal();
+        }
+        DoNotOptimize(sum);
+    }));
+}
+
+}  // namespace bench
+}  // namespace autojson
@@ -0,0 +1,102 @@
+#include "Bench.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "GraphPlotJSONImpl.hpp"
+#include "JSON.hpp"
+#include "Serialize.hpp"
+
+namespace autojson {
+namespace bench {
+
+namespace {
+
+GraphPlot MakePlot(int edges, int nodes) {
+    GraphPlot plot;
+    plot.x_size = plot.y_size = 500;
+    for (int i = 0; i < edges; i += 1) {
+        plot.all_edges.push_back({"node" + std::to_string(i % nodes), "node" + std::to_string(i * 7 % nodes), i % 2});
+    }
+    for (int i = 0; i < nodes; i += 1) {
+        plot.node_info["node" + std::to_string(i)] = {i % 500, i * 3 % 500};
+    }
+    return plot;
+}
+
+// What the generated JSON constructors do: one object per class, filled key by key
+JSON PlotToDOM(const GraphPlot &plot) {
+    JSON result(JSONType::OBJECT);
+    result["xSize"] = plot.x_size;
+    result["ySize"] = plot.y_size;
+
+    JSON &edges = result["allEdges"];
+    for (const GraphPlot::Edge &edge : plot.all_edges) {
+        JSON item(JSONType::OBJECT);
+        item["source"] = edge.source;
+        item["target"] = edge.target;
+        item["isDirected"] = edge.is_directed;
+        edges.push_back(std::move(item));
+    }
+
+    JSON &nodes = result["nodeInfo"];
+    for (const auto &itr : plot.node_info) {
+        JSON item(JSONType::OBJECT);
+        item["xPos"] = itr.second.x_pos;
+        item["yPos"] = itr.second.y_pos;
+        nodes[itr.first] = std::move(item);
+    }
+    return result;
+}
+
+// What the generated conversion operators do: parse the whole tree, then look up every field
+GraphPlot PlotFromDOM(const JSON &json) {
+    GraphPlot plot;
+    plot.x_size = json["xSize"];
+    plot.y_size = json["ySize"];
+    for (const JSON &item : json["allEdges"]) {
+        plot.all_edges.push_back({item["source"], item["target"], item["isDirected"]});
+    }
+    std::map<std::string, JSON> nodes = json["nodeInfo"];
+    for (const auto &itr : nodes) {
+        plot.node_info[itr.first] = {itr.second["xPos"], itr.second["yPos"]};
+    }
+    return plot;
+}
+
+}  // namespace
+
+void RunSerializeBenchmarks() {
+    const GraphPlot plot = MakePlot(100000, 1000);
+    std::string text;
+    PlotToDOM(plot).stringify(text);
+    const size_t size = text.size();
+
+    Report(Measure("serialize/graph-plot/dom", size, [&]() {
+        text.clear();
+        PlotToDOM(plot).stringify(text);
+        DoNotOptimize(text);
+    }));
+
+    Report(Measure("serialize/graph-plot/writer", size, [&]() {
+        text.clear();
+        JSONWriter writer(text);
+        write(writer, plot);
+        DoNotOptimize(text);
+    }));
+
+    Report(Measure("deserialize/graph-plot/dom", size, [&]() {
+        GraphPlot result = PlotFromDOM(JSON::parse(text));
+        DoNotOptimize(result);
+    }));
+
+    GraphPlot result;
+    Report(Measure("deserialize/graph-plot/reader", size, [&]() {
+        ParseInto(text, result);
+        DoNotOptimize(result);
+    }));
+}
+
+}  // namespace bench
+}  // namespace autojson
@@ -0,0 +1,82 @@
+#include "Bench.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "JSON.hpp"
+#include "Snapshot.hpp"
+
+namespace autojson {
+namespace bench {
+
+void RunSnapshotBenchmarks() {
+    const std::string text = TelemetryDocument(100000);
+    const JSON doc = JSON::parse(text);
+
+    // both files stay in the page cache, so this compares the work of loading them
+    const std::string textFile = "autojson-bench-telemetry.json";
+    const std::string snapshotFile = "autojson-bench-telemetry.snap";
+    std::ofstream(textFile, std::ios::out | std::ios::binary) << text;
+    JSONSnapshot::writeToFile(doc, snapshotFile);
+
+    Report(Measure("load/telemetry/read-from-file", text.size(), [&]() {
+        JSON j = JSON::readFromFile(textFile);
+        DoNotOptimize(j);
+    }));
+
+    Report(Measure("load/telemetry/snapshot", text.size(), [&]() {
+        JSONSnapshot snapshot;
+        snapshot.open(snapshotFile);
+        long long first = snapshot.root()[0]["metrics"]["rss"];
+        DoNotOptimize(first);
+    }));
+
+    Report(Measure("lookup/telemetry/tree", 0, [&]() {
+        long long sum = 0;
+        for (const JSON &record : doc) {
+            sum += (long long)record["metrics"]["rss"];
+        }
+        DoNotOptimize(sum);
+    }));
+
+    JSONSnapshot snapshot;
+    snapshot.open(snapshotFile);
+    Report(Measure("lookup/telemetry/snapshot", 0, [&]() {
+        long long sum = 0;
+        for (JSONView record : snapshot.root()) {
+            sum += (long long)record["metrics"]["rss"];
+        }
+        DoNotOptimize(sum);
+    }));
+
+    std::remove(textFile.c_str());
+    std::remove(snapshotFile.c_str());
+
+    // every thread walks all the records, so scaling linearly keeps the time per op flat
+    const JSONFrozen frozen = doc.freeze();
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; threads <= cores; threads *= 2) {
+        Report(Measure("lookup/telemetry/frozen/threads-" + std::to_string(threads), 0, [&]() {
+            std::vector<std::thread> readers;
+            for (unsigned i = 0; i < threads; i += 1) {
+                readers.emplace_back([&frozen]() {
+                    long long sum = 0;
+                    for (JSONView record : frozen.root()) {
+                        sum += (long long)record["metrics"]["rss"];
+                    }
+                    DoNotOptimize(sum);
+                });
+            }
+            for (auto& itr : readers) {
+                itr.join();
+            }
+        }));
+    }
+}
+
+}  // namespace bench
+}  // namespace autojson
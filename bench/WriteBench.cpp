@@ -0,0 +1,74 @@
+#include "Bench.hpp"
+
+#include <sstream>
+#include <string>
+
+#include "JSON.hpp"
+#include "Writer.hpp"
+
+namespace autojson {
+namespace bench {
+
+namespace {
+
+JSON RecordsDocument(int records) {
+    JSON doc(JSONType::VECTOR);
+    for (int i = 0; i < records; i += 1) {
+        JSON record;
+        record["id"] = i;
+        record["score"] = i % 100 + 0.5;
+        record["active"] = (i % 2 == 0);
+        record["name"] = "user" + std::to_string(i);
+        record["note"] = "line one\nline \"two\"";
+        record["tags"] = {"a", "bb", "ccc"};
+        doc.push_back(record);
+    }
+    return doc;
+}
+
+}  // namespace
+
+void RunWriteBenchmarks() {
+    const JSON doc = RecordsDocument(2000);
+    const size_t size = doc.stringify().size();
+
+    Report(Measure("stringify/records", size, [&]() {
+        std::string text = doc.stringify();
+        DoNotOptimize(text);
+    }));
+
+    Report(Measure("stringify/records/pretty", doc.stringify(false).size(), [&]() {
+        std::string text = doc.stringify(false);
+        DoNotOptimize(text);
+    }));
+
+    std::string buffer;
+    Report(Measure("stringify/records/reused-buffer", size, [&]() {
+        buffer.clear();
+        doc.stringify(buffer);
+        DoNotOptimize(buffer);
+    }));
+
+    for (const auto &corpus : Corpora()) {
+        const JSON value = JSON::parse(corpus.second);
+        Report(Measure("stringify/corpus/" + corpus.first, value.stringify().size(), [&]() {
+            std::string text = value.stringify(true);
+            DoNotOptimize(text);
+        }));
+
+        Report(Measure("stringify/corpus/" + corpus.first + "/pretty", value.stringify(false).size(), [&]() {
+            std::string text = value.stringify(false);
+            DoNotOptimize(text);
+        }));
+    }
+
+    std::ostringstream os;
+    Report(Measure("stringify/records/ostream", size, [&]() {
+        os.str("");
+        os << doc;
+        DoNotOptimize(os);
+    }));
+}
+
+}  // namespace bench
+}  // namespace autojson
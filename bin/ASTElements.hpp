@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 void TrimSpaces(std::string& txt) {
     while (txt.size() and txt.back() == ' ') {
@@ -106,6 +107,14 @@ struct Field {
     }
 };
 
+struct EnumValue {
+    std::string name;
+    // same value as an enumerator before it, like Default = Red or Min = 1 after Low = 1
+    bool isAlias;
+    // the value could be worked out from the initializers, so isAlias is certain
+    bool known;
+};
+
 struct Class {
     std::string filePath;
     std::string scope;
@@ -113,6 +122,7 @@ struct Class {
     std::vector<Field> fields;
 
     bool isEnum;
+    std::vector<EnumValue> values;
 };
 
 struct ClassBundle {
@@ -127,6 +137,22 @@ struct ClassBundle {
 
     std::map<std::string, int> unknownClasses;
 
+    // Every way a field can name a class, from its name alone up to its full scope, to the
+    // full scope of the first class named like that. Built by upgradeScopes.
+    std::unordered_map<std::string, std::string> classIndex;
+
+    void indexClasses() {
+        this->classIndex.clear();
+        for (auto& targetClass : this->allClasses) {
+            std::string classType = targetClass.scope + targetClass.name;
+            this->classIndex.emplace(classType, classType);
+            for (size_t separator = classType.find("::"); separator != std::string::npos;
+                 separator = classType.find("::", separator + 2)) {
+                this->classIndex.emplace(classType.substr(separator + 2), classType);
+            }
+        }
+    }
+
     void updateFieldType(FieldType &type) {
         // solve childrens
         for (auto& itr : type.templateTypes) {
@@ -139,24 +165,16 @@ struct ClassBundle {
         std::string cleanType = onlyBaseType.onlyType();
         std::string remainingType = onlyBaseType.type.substr(cleanType.size(), onlyBaseType.type.size());
 
-        for (auto builtinClass : this->builtinClasses) {
+        for (const auto& builtinClass : this->builtinClasses) {
             if (cleanType == builtinClass) {
                 return;
             }
         }
 
-        for (auto& targetClass : this->allClasses) {
-            // check if classType ends with my type
-            std::string classType = targetClass.scope + targetClass.name;
-
-            if (classType.size() < cleanType.size()) {
-                continue;
-            }
-
-            if (cleanType == classType.substr(classType.size() - cleanType.size(), cleanType.size())) {
-                type.name = classType + remainingType;
-                return;
-            }
+        auto targetClass = this->classIndex.find(cleanType);
+        if (targetClass != this->classIndex.end()) {
+            type.name = targetClass->second + remainingType;
+            return;
         }
 
         if (unknownClasses[cleanType] == 1) {
@@ -179,6 +197,7 @@ struct ClassBundle {
 
     void upgradeScopes() {
         this->unknownClasses.clear();
+        this->indexClasses();
         for (auto& cls : this->allClasses) {
             for (auto& field : cls.fields) {
                 this->updateField(field);
@@ -190,14 +209,28 @@ struct ClassBundle {
 
 std::vector<std::string> ClassBundle::builtinClasses = {
     "char",
+    "signed char",
+    "unsigned char",
     "bool",
+    "short",
+    "unsigned short",
     "int",
+    "unsigned int",
     "long",
     "unsigned long",
     "long long",
-    "unsided long long",
+    "unsigned long long",
+    "int8_t",
+    "uint8_t",
+    "int16_t",
+    "uint16_t",
+    "int32_t",
+    "uint32_t",
+    "int64_t",
+    "uint64_t",
     "float",
     "double",
+    "long double",
     "vector",
     "std::vector",
     "string",
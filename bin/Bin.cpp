@@ -1,12 +1,110 @@
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
 
 #include "CodeGenerator.hpp"
 #include "Parse.hpp"
 
 using namespace std;
 
-void SolveFile(const string& file) {
-    auto content = ReadFromFile(file);
+// Outputs depend on the generator and on the flags, so cached results are only valid for the
+// generator that produced them. Bump this whenever a change to CodeGenerator or Parse changes
+// the generated code; rebuilding autojson-bin alone keeps the cache.
+const string kGeneratorVersion = "3";
+
+uint64_t ContentHash(const string& content) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : content) {
+        hash = (hash ^ (unsigned char)c) * 1099511628211ull;
+    }
+    return hash;
+}
+
+bool FileExists(const string& file) {
+    return bool(ifstream(file));
+}
+
+// file with JSONImpl added before its extension
+string OutputFile(const string& file) {
+    string finalFile = file;
+    string remainingFile = "";
+
+    while (finalFile.size()) {
+        remainingFile += finalFile.back();
+        if (finalFile.back() == '.') {
+            finalFile.pop_back();
+            break;
+        }
+
+        finalFile.pop_back();
+    }
+
+    finalFile += "JSONImpl";
+    reverse(remainingFile.begin(), remainingFile.end());
+    finalFile += remainingFile;
+    return finalFile;
+}
+
+// Writes content unless the file already holds exactly that, so outputs that did not change
+// keep their mtime and what depends on them is not rebuilt
+void WriteIfChanged(const string& file, const string& content) {
+    ifstream fin(file, ios::in | ios::binary);
+    if (fin) {
+        stringstream current;
+        current << fin.rdbuf();
+        if (current.str() == content) {
+            return;
+        }
+    }
+    fin.close();
+
+    ofstream fout(file, ios::out | ios::binary);
+    fout << content;
+    fout.close();
+}
+
+// Inputs whose output is up to date, as input path -> hash of the content it was generated
+// from. Empty when the cache was written for another version or other flags.
+map<string, uint64_t> ReadCache(const string& path, const string& version) {
+    map<string, uint64_t> entries;
+    ifstream fin(path);
+    string line;
+    if (not getline(fin, line) or line != version) {
+        return entries;
+    }
+
+    while (getline(fin, line)) {
+        size_t space = line.find(' ');
+        if (space == string::npos) {
+            continue;
+        }
+        entries[line.substr(space + 1)] = strtoull(line.substr(0, space).c_str(), nullptr, 16);
+    }
+    return entries;
+}
+
+void WriteCache(const string& path, const string& version, const map<string, uint64_t>& entries) {
+    // written next to the cache and renamed over it, so an interrupted run cannot leave half a cache
+    string temporaryPath = path + ".tmp";
+    ofstream fout(temporaryPath);
+    fout << version << '\n';
+    for (auto& itr : entries) {
+        char hash[17];
+        snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)itr.second);
+        fout << hash << ' ' << itr.first << '\n';
+    }
+    fout.close();
+    rename(temporaryPath.c_str(), path.c_str());
+}
+
+// Generated code for the classes of a header, with what was found in it appended to log
+string GenerateFile(const string& file, string content, bool enumNames, bool streamOnly, string& log) {
 /*
     cerr << "~~~~~~~~~~~~~~~~~~~~~~\n";
     cerr << EraseComments(content) << '\n';
@@ -19,9 +117,11 @@ void SolveFile(const string& file) {
 
     cb.upgradeScopes();
 
+    // kept apart per file, so parallel runs print the files one after the other
+    stringstream cout;
     cout << "+-+-+-+-+-+-+-+-+-+-+-+-+-+\n";
     cout << "Found the following classes\n";
-    for (auto itr : cb.allClasses) {
+    for (const auto& itr : cb.allClasses) {
         auto scope = itr.scope;
         auto cls = itr;
         cout << "Name:\t" << cls.name << '\n';
@@ -37,47 +137,128 @@ void SolveFile(const string& file) {
     string fileContent = "";
 
     {
-        std::string shortFile = file;
         int start = 0;
 
         for (int i = 0; i < (int)file.size(); i += 1) {
             if (file[i] == '/') {
-                start = i;
+                start = i + 1;
             }
         }
 
         fileContent += "#include \"" + file.substr(start, file.size()) + "\"\n"
-                        "#include <JSON>\n\n";
+                        "#include <JSON.hpp>\n"
+                        "#include <Serialize.hpp>\n\n";
     }
 
-    for (auto itr : cb.allClasses) {
-        fileContent += JSONifyClass(itr);
+    fileContent += "namespace autojson {\n";
+    for (const auto& itr : cb.allClasses) {
+        if (itr.isEnum) {
+            fileContent += EnumNameDeclarations(itr);
+        }
+        fileContent += JSONWriterDeclaration(itr);
+        fileContent += JSONReaderDeclaration(itr);
     }
+    fileContent += "}  //namespace autojson\n\n";
 
-    string finalFile = file;
-    string remainingFile = "";
-
-    while (finalFile.size()) {
-        remainingFile += finalFile.back();
-        if (finalFile.back() == '.') {
-            finalFile.pop_back();
-            break;
+    for (const auto& itr : cb.allClasses) {
+        if (itr.isEnum) {
+            fileContent += EnumNamesClass(itr);
         }
+    }
 
-        finalFile.pop_back();
+    for (const auto& itr : cb.allClasses) {
+        fileContent += JSONWriterClass(itr, enumNames);
     }
 
-    finalFile += "JSONImpl";
-    reverse(remainingFile.begin(), remainingFile.end());
-    finalFile += remainingFile;
+    for (const auto& itr : cb.allClasses) {
+        fileContent += JSONReaderClass(itr);
+    }
 
-    ofstream fout(finalFile);
-    fout << fileContent << '\n';
-    fout.close();
+    if (not streamOnly) {
+        for (const auto& itr : cb.allClasses) {
+            fileContent += JSONifyClass(itr);
+        }
+    }
+
+    log += cout.str();
+    return fileContent;
 }
 
 int main(int argc, char** argv) {
+    // --enum-names makes the generated writers write enums as the names of their values
+    bool enumNames = false;
+    // --stream-only leaves out the JSON constructors and conversion operators, for code that
+    // only goes through write() and read()
+    bool streamOnly = false;
+    // -j N generates N headers at a time, -j 0 as many as there are cores
+    unsigned jobs = 1;
+    // --cache FILE skips headers whose content did not change since the run that wrote FILE
+    string cachePath = "";
+    vector<string> files;
+
     for (int i = 1; i < argc; i += 1) {
-        SolveFile(argv[i]);
+        string arg = argv[i];
+        if (arg == "--enum-names") {
+            enumNames = true;
+        } else if (arg == "--stream-only") {
+            streamOnly = true;
+        } else if (arg == "-j" and i + 1 < argc) {
+            jobs = atoi(argv[++i]);
+        } else if (arg.size() > 2 and arg.substr(0, 2) == "-j") {
+            jobs = atoi(arg.c_str() + 2);
+        } else if (arg == "--cache" and i + 1 < argc) {
+            cachePath = argv[++i];
+        } else if (find(files.begin(), files.end(), arg) == files.end()) {
+            files.push_back(arg);
+        }
+    }
+
+    if (jobs == 0) {
+        jobs = max(1u, thread::hardware_concurrency());
+    }
+
+    string version = kGeneratorVersion + (enumNames ? " --enum-names" : "") + (streamOnly ? " --stream-only" : "");
+    map<string, uint64_t> cache;
+    if (cachePath.size()) {
+        cache = ReadCache(cachePath, version);
+    }
+
+    // every worker takes the next file and only touches the slots of that file
+    vector<string> logs(files.size());
+    vector<uint64_t> hashes(files.size());
+    atomic<size_t> next(0);
+    auto Work = [&]() {
+        for (size_t i = next++; i < files.size(); i = next++) {
+            string content = ReadFromFile(files[i]);
+            string outputFile = OutputFile(files[i]);
+            hashes[i] = ContentHash(content);
+
+            auto cached = cache.find(files[i]);
+            if (cached != cache.end() and cached->second == hashes[i] and FileExists(outputFile)) {
+                continue;
+            }
+
+            WriteIfChanged(outputFile, GenerateFile(files[i], content, enumNames, streamOnly, logs[i]) + '\n');
+        }
+    };
+
+    vector<thread> workers;
+    for (size_t i = 1; i < min<size_t>(jobs, files.size()); i += 1) {
+        workers.emplace_back(Work);
+    }
+    Work();
+    for (auto& itr : workers) {
+        itr.join();
+    }
+
+    for (auto& itr : logs) {
+        cout << itr;
+    }
+
+    if (cachePath.size()) {
+        for (int i = 0; i < (int)files.size(); i += 1) {
+            cache[files[i]] = hashes[i];
+        }
+        WriteCache(cachePath, version, cache);
     }
 }
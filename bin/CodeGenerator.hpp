@@ -2,7 +2,11 @@
 #define AUTOJSON_BIN_CODE_GENERATOR_HPP
 
 #include "ASTElements.hpp"
+#include "Reader.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <vector>
 #include <string>
 
@@ -27,6 +31,334 @@ std::string JSONFieldName(const std::string &name) {
     return result;
 }
 
+// Key as it is written between the quotes in the JSON, escaped the same way the JSONWriter
+// escapes keys. Done here, once, so the generated writers copy it as is.
+std::string EscapedJSONKey(const std::string &name) {
+    std::string result = "";
+    for (char c : name) {
+        switch (c) {
+            case '"': result += "\\\""; break;
+            case '\n': result += "\\n"; break;
+            case '\r': result += "\\r"; break;
+            case '\t': result += "\\t"; break;
+            default: result += c;
+        }
+    }
+    return result;
+}
+
+std::string CppStringLiteral(const std::string &text) {
+    std::string result = "\"";
+    for (char c : text) {
+        if (c == '"' or c == '\\') {
+            result += '\\';
+        }
+        result += c;
+    }
+    return result + "\"";
+}
+
+// hash(name, seed) & (slots - 1) is different for every name, hash being NameHash or
+// FullNameHash
+struct PerfectHash {
+    bool full;
+    uint32_t seed;
+    uint32_t slots;
+
+    std::string function() const {
+        return this->full ? "FullNameHash" : "NameHash";
+    }
+
+    uint32_t slot(const std::string &name) const {
+        uint32_t hash = this->full ? autojson::FullNameHash(name.data(), name.size(), this->seed)
+                                   : autojson::NameHash(name.data(), name.size(), this->seed);
+        return hash & (this->slots - 1);
+    }
+};
+
+// Smallest table, and the first seed, for which the names do not collide. maxSlots bounds
+// the search, false when it gives up.
+bool FindPerfectHash(const std::vector<std::string> &names, PerfectHash &hash, uint32_t maxSlots) {
+    hash.slots = 1;
+    while (hash.slots < names.size()) {
+        hash.slots *= 2;
+    }
+
+    // a table with as many slots as names rarely has a perfect seed, so grow it when none
+    // of the first few thousand seeds work
+    std::vector<bool> used;
+    for (; hash.slots <= maxSlots; hash.slots *= 2) {
+        for (hash.seed = 0; hash.seed < (1 << 12); hash.seed += 1) {
+            used.assign(hash.slots, false);
+            bool collision = false;
+            for (auto &name : names) {
+                uint32_t slot = hash.slot(name);
+                if (used[slot]) {
+                    collision = true;
+                    break;
+                }
+                used[slot] = true;
+            }
+
+            if (not collision) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// names must be distinct
+PerfectHash FindPerfectHash(const std::vector<std::string> &names) {
+    PerfectHash hash = {false, 0, 1};
+    uint32_t maxSlots = 64;
+    while (maxSlots < 4 * names.size()) {
+        maxSlots *= 2;
+    }
+
+    // NameHash can only work when no two names have the same size, first and last byte
+    bool positionsDiffer = true;
+    for (int i = 0; i < (int)names.size(); i += 1) {
+        for (int j = 0; j < i; j += 1) {
+            positionsDiffer = positionsDiffer and not (names[i].size() == names[j].size() and
+                (names[i].empty() or (names[i].front() == names[j].front() and names[i].back() == names[j].back())));
+        }
+    }
+
+    if (positionsDiffer and FindPerfectHash(names, hash, maxSlots)) {
+        return hash;
+    }
+
+    hash.full = true;
+    while (not FindPerfectHash(names, hash, maxSlots)) {
+        maxSlots *= 2;
+    }
+    return hash;
+}
+
+// switch over the slots of names, with one case per name from caseBody(index of the name).
+// Names missing from their slot fall through to the code after the switch.
+std::string PerfectHashSwitch(const std::vector<std::string> &names, const std::string &text,
+                              const std::function<std::string(int)> &caseBody, const std::string &indent) {
+    PerfectHash hash = FindPerfectHash(names);
+    std::vector<int> order(names.size());
+    for (int i = 0; i < (int)names.size(); i += 1) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](int lhs, int rhs) {
+        return hash.slot(names[lhs]) < hash.slot(names[rhs]);
+    });
+
+    std::string result =
+        indent + "switch (" + hash.function() + "(" + text + ".data(), " + text + ".size(), " + std::to_string(hash.seed) + "u) & " +
+        std::to_string(hash.slots - 1) + ") {\n";
+    for (int itr : order) {
+        result +=
+            indent + "\tcase " + std::to_string(hash.slot(names[itr])) + ":\n" +
+            indent + "\t\tif (" + text + " == " + CppStringLiteral(names[itr]) + ") {\n" +
+            caseBody(itr) +
+            indent + "\t\t}\n" +
+            indent + "\t\tbreak;\n";
+    }
+    result += indent + "}\n";
+    return result;
+}
+
+std::string EnumNameDeclarations(const Class &c) {
+    return
+        "inline std::string_view ToString(" + c.scope + c.name + " rhs);\n"
+        "inline bool FromString(std::string_view name, " + c.scope + c.name + "& rhs);\n";
+}
+
+// ToString and FromString between an enum and the names of its values
+std::string EnumNamesClass(const Class &c) {
+    std::string type = c.scope + c.name;
+    std::string result = "";
+
+    // a value that could not be worked out may equal another one, which a switch would refuse
+    bool allKnown = true;
+    for (auto &itr : c.values) {
+        allKnown = allKnown and (itr.known or itr.isAlias);
+    }
+
+    result +=
+        "namespace autojson {\n"
+        "inline std::string_view ToString(" + type + " rhs) {\n";
+    if (allKnown) {
+        // one case per value, named after the first enumerator that has it
+        result += "\tswitch (rhs) {\n";
+        for (auto &itr : c.values) {
+            if (itr.isAlias) {
+                continue;
+            }
+            result +=
+                "\t\tcase " + type + "::" + itr.name + ":\n"
+                "\t\t\treturn " + CppStringLiteral(itr.name) + ";\n";
+        }
+        result +=
+            "\t\tdefault:\n"
+            "\t\t\treturn \"\";\n"
+            "\t}\n";
+    } else {
+        for (auto &itr : c.values) {
+            if (itr.isAlias) {
+                continue;
+            }
+            result +=
+                "\tif (rhs == " + type + "::" + itr.name + ") {\n"
+                "\t\treturn " + CppStringLiteral(itr.name) + ";\n"
+                "\t}\n";
+        }
+        result += "\treturn \"\";\n";
+    }
+    result += "}\n\n";
+
+    std::vector<std::string> names;
+    for (auto &itr : c.values) {
+        names.push_back(itr.name);
+    }
+
+    result += "inline bool FromString(std::string_view name, " + type + "& rhs) {\n";
+    if (names.empty()) {
+        result +=
+            "\t(void)name;\n"
+            "\t(void)rhs;\n";
+    } else {
+        result += PerfectHashSwitch(names, "name", [&](int index) {
+            return
+                "\t\t\t\trhs = " + type + "::" + names[index] + ";\n"
+                "\t\t\t\treturn true;\n";
+        }, "\t");
+    }
+    result +=
+        "\treturn false;\n"
+        "}\n"
+        "}  //namespace autojson\n\n";
+
+    return result;
+}
+
+std::string JSONWriterSignature(const Class &c) {
+    return "inline void write(JSONWriter &writer, const " + c.scope + c.name + "& rhs)";
+}
+
+// Declared up front so the writers of classes using each other can come in any order
+std::string JSONWriterDeclaration(const Class &c) {
+    return JSONWriterSignature(c) + ";\n";
+}
+
+// Streams the class straight into a JSONWriter, without building a JSON first. Enums are
+// written as numbers, or as the names of their values with enumNames.
+std::string JSONWriterClass(const Class &c, bool enumNames) {
+    std::string result = "";
+
+    result +=
+        "namespace autojson {\n" +
+        JSONWriterSignature(c) + " {\n";
+
+    if (c.isEnum and enumNames) {
+        result +=
+            "\tstd::string_view name = ToString(rhs);\n"
+            "\tif (name.empty()) {\n"
+            "\t\twriter.integer((long long)rhs);\n"
+            "\t} else {\n"
+            "\t\twriter.string(name.data(), name.size());\n"
+            "\t}\n";
+    } else if (c.isEnum) {
+        result += "\twriter.integer((long long)rhs);\n";
+    } else {
+        // sorted like the keys of a JSON object, so both paths give the same text
+        std::vector<Field> fields = c.fields;
+        std::stable_sort(fields.begin(), fields.end(), [](const Field &lhs, const Field &rhs) {
+            return JSONFieldName(lhs.name) < JSONFieldName(rhs.name);
+        });
+
+        result += "\twriter.startObject();\n";
+        for (auto itr : fields) {
+            std::string key = EscapedJSONKey(JSONFieldName(itr.name));
+            result +=
+                "\twriter.escapedKey(" + CppStringLiteral(key) + ", " + std::to_string(key.size()) + ");\n"
+                "\twrite(writer, rhs." + itr.name + ");\n";
+        }
+        if (c.fields.empty()) {
+            result += "\t(void)rhs;\n";
+        }
+        result += "\twriter.endObject();\n";
+    }
+
+    result += "}\n";
+    result += "}  //namespace autojson\n\n";
+
+    return result;
+}
+
+std::string JSONReaderSignature(const Class &c) {
+    return "inline void read(JSONReader &reader, " + c.scope + c.name + "& rhs)";
+}
+
+std::string JSONReaderDeclaration(const Class &c) {
+    return JSONReaderSignature(c) + ";\n";
+}
+
+// Parses the class straight from a JSONReader: every key is matched to the field it names
+// through a perfect hash and the value is read into that field, other keys are skipped.
+// Enums are read from their number or from the name of their value.
+std::string JSONReaderClass(const Class &c) {
+    std::string result = "";
+
+    result +=
+        "namespace autojson {\n" +
+        JSONReaderSignature(c) + " {\n";
+
+    if (c.isEnum) {
+        result +=
+            "\tstd::string_view name;\n"
+            "\tif (not reader.readName(name)) {\n"
+            "\t\tlong long value = (long long)rhs;\n"
+            "\t\tread(reader, value);\n"
+            "\t\trhs = " + c.scope + c.name + "(value);\n"
+            "\t} else if (not FromString(name, rhs)) {\n"
+            "\t\treader.unexpected(" + CppStringLiteral("a name of " + c.scope + c.name) + ");\n"
+            "\t}\n";
+    } else {
+        // when two fields have the same JSON name, the first one gets the value
+        std::vector<std::string> names;
+        std::vector<std::string> members;
+        for (auto itr : c.fields) {
+            std::string name = JSONFieldName(itr.name);
+            if (std::find(names.begin(), names.end(), name) == names.end()) {
+                names.push_back(name);
+                members.push_back(itr.name);
+            }
+        }
+
+        result +=
+            "\tstd::string_view key;\n"
+            "\tif (not reader.startObject()) {\n"
+            "\t\treturn;\n"
+            "\t}\n"
+            "\twhile (reader.nextKey(key)) {\n";
+        if (names.size()) {
+            result += PerfectHashSwitch(names, "key", [&](int index) {
+                return
+                    "\t\t\t\t\tread(reader, rhs." + members[index] + ");\n"
+                    "\t\t\t\t\tcontinue;\n";
+            }, "\t\t");
+        }
+        result +=
+            "\t\treader.skipValue();\n"
+            "\t}\n";
+        if (c.fields.empty()) {
+            result += "\t(void)rhs;\n";
+        }
+    }
+
+    result += "}\n";
+    result += "}  //namespace autojson\n\n";
+
+    return result;
+}
+
 std::string JSONifyClass(Class c) {
     std::string result = "";
 
@@ -36,7 +368,7 @@ std::string JSONifyClass(Class c) {
         "autojson::JSON::JSON(";
     result += ((c.fields.size()) ? "" : "__attribute__((unused)) ");
     result +=
-        "const " + c.scope + c.name + "& rhs) : type(JSONType::OBJECT), content(new std::map<std::string, JSON>()) {\n";
+        "const " + c.scope + c.name + "& rhs) : JSON(JSONType::OBJECT) {\n";
 
     for (auto itr : c.fields) {
         result += "\t(*this)[\"" + JSONFieldName(itr.name) + "\"] = rhs." + itr.name + ";\n";
@@ -3,115 +3,91 @@
 
 #include "ASTElements.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
 #include <functional>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 
+// content without its comments. String and character literals are copied as they are, so a
+// "//" inside one is not taken for a comment.
 std::string EraseComments(const std::string &content) {
     std::string result;
-    result += content[0];
-
-    bool quoted = false;
-    bool commented = false;
-
-    int index = 1;
-    while (index < (int)content.size()) {
-        if (commented) {
-            if (content[index] == '/' and content[index - 1] == '*') {
-                commented = false;
-            }
-            index++;
-            continue;
-        }
-
-        if (quoted) {
-            result += content[index];
-            if (content[index - 1] != '\\' and content[index] == '"') {
-                ;
-            } else {
-                quoted = false;
-            }
-            index++;
-            continue;
-        }
-
-        if (content[index - 1] == '/' and content[index] == '*') {
-            result.pop_back();
-            commented = true;
-            index++;
-            continue;
-        }
-
-        if (content[index - 1] == '/' and content[index] == '/') {
-            result.pop_back();
-            while (content[index] != '\n') {
-                index++;
+    result.reserve(content.size());
+
+    size_t index = 0;
+    while (index < content.size()) {
+        char c = content[index];
+        char next = index + 1 < content.size() ? content[index + 1] : '\0';
+
+        if (c == '/' and next == '/') {
+            // the newline stays, it still separates words
+            index = std::min(content.find('\n', index), content.size());
+        } else if (c == '/' and next == '*') {
+            size_t end = content.find("*/", index + 2);
+            index = (end == std::string::npos) ? content.size() : end + 2;
+            result += ' ';
+        } else if (c == '"' or c == '\'') {
+            size_t start = index;
+            index += 1;
+            while (index < content.size() and content[index] != c) {
+                index += (content[index] == '\\') ? 2 : 1;
             }
-            continue;
-        }
-
-        if (content[index - 1] != '\\' and content[index] == '\"') {
-            quoted = true;
-            result += content[index];
-            index++;
-            continue;
+            index = std::min(index + 1, content.size());
+            result.append(content, start, index - start);
+        } else {
+            result += c;
+            index += 1;
         }
-
-        result += content[index];
-        index++;
     }
     return result;
 }
 
-std::vector<std::string> GetWords(const std::string &content) {
-    std::string standalone = "{}:;()[],<>";
-    auto IsStandalone = [&](char c) {
-        for (char itr : standalone) {
-            if (itr == c) {
-                return true;
-            }
+// Words of content, each a view into it: punctuation characters are words on their own, and
+// whitespace separates the others
+std::vector<std::string_view> GetWords(const std::string &content) {
+    enum CharKind : unsigned char { WORD = 0, STANDALONE, DELIMITER };
+    static const std::array<CharKind, 256> kinds = [] {
+        std::array<CharKind, 256> result{};
+        for (char c : std::string_view("{}:;()[],<>")) {
+            result[(unsigned char)c] = STANDALONE;
         }
-        return false;
-    };
+        for (char c : std::string_view("\t\n\r ")) {
+            result[(unsigned char)c] = DELIMITER;
+        }
+        return result;
+    }();
 
+    std::vector<std::string_view> words;
+    words.reserve(content.size() / 4);
 
-    std::string delimiters = "\t\n ";
-    auto IsDelimiter = [&](char c) {
-        for (char itr : delimiters) {
-            if (itr == c) {
-                return true;
-            }
+    const char *data = content.data();
+    size_t start = 0;
+    for (size_t i = 0; i < content.size(); i += 1) {
+        CharKind kind = kinds[(unsigned char)data[i]];
+        if (kind == WORD) {
+            continue;
         }
-        return false;
-    };
 
-    std::vector<std::string> words;
-    std::string currentWord = "";
-    auto Add = [&]() {
-        if (currentWord.size() == 0) {
-            return;
+        if (i > start) {
+            words.emplace_back(data + start, i - start);
         }
-        words.push_back(currentWord);
-        currentWord = "";
-    };
-
-
-    for (char itr : content) {
-        if (IsStandalone(itr)) {
-            Add();
-            currentWord = itr;
-            Add();
-        } else if (IsDelimiter(itr)) {
-            Add();
-        } else {
-            currentWord += itr;
+        if (kind == STANDALONE) {
+            words.emplace_back(data + i, 1);
         }
+        start = i + 1;
     }
 
-    Add();
+    if (content.size() > start) {
+        words.emplace_back(data + start, content.size() - start);
+    }
 
     return words;
 }
@@ -135,7 +111,31 @@ std::string ReadFromFile(const std::string& file) {
     return fileInformation;
 }
 
-ClassBundle ParseClasses(const std::vector<std::string>& words) {
+// Value of an integer literal such as 12, -0x1F or 3u, false for anything else
+bool ParseIntegerLiteral(std::string text, long long &value) {
+    while (text.size() and (text.back() == 'u' or text.back() == 'U' or text.back() == 'l' or text.back() == 'L')) {
+        text.pop_back();
+    }
+    text.erase(std::remove(text.begin(), text.end(), '\''), text.end());
+
+    bool negative = text.size() and text[0] == '-';
+    size_t start = negative ? 1 : 0;
+    if (start >= text.size() or not isdigit((unsigned char)text[start])) {
+        return false;
+    }
+
+    errno = 0;
+    char *end = nullptr;
+    long long number = strtoll(text.c_str() + start, &end, 0);
+    if (errno != 0 or *end != '\0') {
+        return false;
+    }
+    value = negative ? -number : number;
+    return true;
+}
+
+// words must outlive the call, they are views into the header
+ClassBundle ParseClasses(const std::vector<std::string_view>& words) {
     std::map<std::string, Class> classes;
 
     std::string scope = "::";
@@ -150,6 +150,70 @@ ClassBundle ParseClasses(const std::vector<std::string>& words) {
         }
     };
 
+    // enumerator names up to the closing }, with their values when the initializers are
+    // literals or other enumerators
+    auto ParseEnumValues = [&](Class &c) {
+        std::vector<long long> values;
+        long long next = 0;
+        bool nextKnown = true;
+        while (index < (int)words.size() and words[index] != "}") {
+            std::string name(words[index]);
+            std::string initializer = "";
+            index += 1;
+
+            size_t equals = name.find('=');
+            if (equals != std::string::npos) {
+                initializer = name.substr(equals);
+                name = name.substr(0, equals);
+            }
+
+            int depth = 0;
+            while (index < (int)words.size() and (depth or (words[index] != "," and words[index] != "}"))) {
+                if (words[index] == "(") {
+                    depth += 1;
+                } else if (words[index] == ")") {
+                    depth -= 1;
+                }
+                initializer += words[index];
+                index += 1;
+            }
+
+            if (index < (int)words.size() and words[index] == ",") {
+                index += 1;
+            }
+
+            if (initializer.size() and initializer[0] == '=') {
+                initializer.erase(0, 1);
+            }
+
+            long long value = next;
+            bool known = nextKnown;
+            bool isAlias = false;
+            if (initializer.size()) {
+                known = ParseIntegerLiteral(initializer, value);
+                for (int i = 0; i < (int)c.values.size(); i += 1) {
+                    if (c.values[i].name == initializer) {
+                        isAlias = true;
+                        known = c.values[i].known;
+                        value = values[i];
+                    }
+                }
+            }
+
+            for (int i = 0; known and i < (int)c.values.size(); i += 1) {
+                isAlias = isAlias or (c.values[i].known and values[i] == value);
+            }
+            next = value + 1;
+            nextKnown = known;
+
+            if (name.size()) {
+                c.values.push_back({name, isAlias, known});
+                values.push_back(value);
+            }
+        }
+        index += 1;
+    };
+
     std::function<void(bool)> Parse;
 
     Parse = [&](bool add) -> void {
@@ -165,7 +229,7 @@ ClassBundle ParseClasses(const std::vector<std::string>& words) {
 
             auto& current = words[index];
 
-            if (current == "namespace" and words[index - 1] != "using") {
+            if (current == "namespace" and (index == 0 or words[index - 1] != "using")) {
                 hadNamespace = true;
                 lastScopeName = words[index + 1];
                 index += 2;
@@ -174,10 +238,14 @@ ClassBundle ParseClasses(const std::vector<std::string>& words) {
 
             if (current == "class" || current == "struct" || current == "enum") {
                 hadClass = true;
-                lastScopeName = words[index + 1];
                 if (current == "enum") {
                     isEnum = true;
+                    // enum class Name
+                    if (words[index + 1] == "class" or words[index + 1] == "struct") {
+                        index += 1;
+                    }
                 }
+                lastScopeName = words[index + 1];
                 index += 2;
                 continue;
             }
@@ -190,13 +258,17 @@ ClassBundle ParseClasses(const std::vector<std::string>& words) {
 
                     if (hadClass) {
                         if (classes.find(scope) == classes.end()) {
-                            classes[scope] = Class({"", lastScope, lastScopeName, {}, isEnum});
+                            classes[scope] = Class({"", lastScope, lastScopeName, {}, isEnum, {}});
                         } else {
                             hadClass = false;
                         }
                     }
 
-                    Parse(hadClass);
+                    if (hadClass and isEnum) {
+                        ParseEnumValues(classes[scope]);
+                    } else {
+                        Parse(hadClass);
+                    }
 
                     hadNamespace = hadClass = isEnum = false;
                     PopLastScope(scope);
@@ -204,7 +276,7 @@ ClassBundle ParseClasses(const std::vector<std::string>& words) {
                     Parse(false);
                 }
 
-                if (words[index] == ";") {
+                if (index < (int)words.size() and words[index] == ";") {
                     index += 1;
                 }
 
@@ -255,7 +327,7 @@ ClassBundle ParseClasses(const std::vector<std::string>& words) {
                 }
                 firstVal -= 1;
 
-                std::string type = words[startIndex] + " ";
+                std::string type = std::string(words[startIndex]) + " ";
                 if (words[startIndex] == ":") {
                     type.pop_back();
                 }
@@ -268,7 +340,8 @@ ClassBundle ParseClasses(const std::vector<std::string>& words) {
                         }
                         type += ":";
                     } else {
-                        type += words[startIndex] + " ";
+                        type += words[startIndex];
+                        type += " ";
                     }
                     startIndex += 1;
                 }
@@ -276,7 +349,14 @@ ClassBundle ParseClasses(const std::vector<std::string>& words) {
                 type.pop_back();
 
                 while (firstVal < index) {
-                    classes[scope].fields.push_back({type, words[firstVal]});
+                    // a * written against the name makes only that name a pointer, like in int *a, b;
+                    std::string name(words[firstVal]);
+                    std::string fieldType = type;
+                    while (name.size() and name[0] == '*') {
+                        fieldType += "*";
+                        name.erase(0, 1);
+                    }
+                    classes[scope].fields.push_back({fieldType, name});
                     firstVal += 2;
                 }
 
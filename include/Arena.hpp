@@ -0,0 +1,119 @@
+#ifndef AUTOJSON_ARENA_HPP
+#define AUTOJSON_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+namespace autojson {
+
+// Bump allocator. Allocations are carved one after the other out of big blocks and
+// are never freed one by one: release() and the destructor drop everything at once.
+class Arena {
+public:
+    static const size_t kDefaultBlockSize = 64 * 1024;
+
+    explicit Arena(size_t blockSize = kDefaultBlockSize);
+
+    // Starts by carving out of a caller-owned buffer. The buffer is never freed
+    // by the arena and is reused after every release().
+    Arena(void *buffer, size_t size);
+
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        uintptr_t start = ((uintptr_t)this->current + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        if (this->current == nullptr or start + size > (uintptr_t)this->end) {
+            return this->allocateSlow(size, alignment);
+        }
+
+        this->current = (char*)(start + size);
+        this->used += size;
+        return (void*)start;
+    }
+
+    // Drops every allocation. The largest block is kept for the next round so a
+    // reused arena stops calling malloc once it has grown to the usual document size.
+    void release();
+
+    // Bytes handed out since the last release
+    size_t bytesUsed() const {
+        return this->used;
+    }
+
+private:
+    struct Block {
+        Block *next;
+        size_t size;
+    };
+
+    char *current;
+    char *end;
+    Block *blocks;
+    size_t blockSize;
+    size_t used;
+
+    void *userBuffer;
+    size_t userBufferSize;
+
+    void* allocateSlow(size_t size, size_t alignment);
+};
+
+// STL allocator carving from an Arena, or from the global heap when it has none.
+// Copies of a container always go to the heap, so nothing copied out of an arena
+// can outlive it by accident.
+template<typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    typedef std::false_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    Arena *arena;
+
+    ArenaAllocator(Arena *arena = nullptr) noexcept : arena(arena) { }
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U> &rhs) noexcept : arena(rhs.arena) { }
+
+    T* allocate(size_t n) {
+        if (this->arena != nullptr) {
+            return (T*)this->arena->allocate(n * sizeof(T), alignof(T));
+        }
+        return (T*)::operator new(n * sizeof(T));
+    }
+
+    void deallocate(T *p, size_t) noexcept {
+        if (this->arena == nullptr) {
+            ::operator delete(p);
+        }
+    }
+
+    ArenaAllocator select_on_container_copy_construction() const {
+        return ArenaAllocator();
+    }
+};
+
+template<typename T, typename U>
+inline bool operator==(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) {
+    return lhs.arena == rhs.arena;
+}
+
+template<typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) {
+    return lhs.arena != rhs.arena;
+}
+
+}  // namespace autojson
+
+#ifndef autojsonuselib
+#include "autojson_src/Arena.cpp"
+#endif
+
+#endif // AUTOJSON_ARENA_HPP
@@ -0,0 +1,101 @@
+#ifndef AUTOJSON_BINARY_HPP
+#define AUTOJSON_BINARY_HPP
+
+#include <cstddef>
+#include <string>
+
+#include "Handler.hpp"
+#include "JSON.hpp"
+#include "Writer.hpp"
+
+namespace autojson {
+
+// Binary encodings of the same values JSON text holds
+enum BinaryFormat : unsigned char {
+    // RFC 8949
+    CBOR,
+    MESSAGE_PACK
+};
+
+// Writes values in CBOR or MessagePack, like JSONWriter does for text. Numbers are written
+// natively: integers in as few bytes as they fit in, reals as floats when a float holds them
+// exactly and as doubles otherwise. RAW primitives are written as strings.
+// Both formats put the number of entries in front of a container, so there is no end event
+// and the size given to startObject/startArray must match what follows.
+//
+// Example:
+//  std::string out;
+//  BinaryWriter writer(out, CBOR);
+//  writer.startObject(1);
+//  writer.key("id", 2);
+//  writer.integer(1);
+class BinaryWriter {
+public:
+    // Output is buffered and handed to the sink in chunks of about this size
+    static const size_t kFlushSize = 16 * 1024;
+
+    // Appends to output
+    BinaryWriter(std::string &output, BinaryFormat format);
+
+    BinaryWriter(JSONSink &sink, BinaryFormat format);
+
+    // Flushes whatever is still buffered
+    ~BinaryWriter();
+
+    BinaryWriter(const BinaryWriter&) = delete;
+    BinaryWriter& operator=(const BinaryWriter&) = delete;
+
+    void write(const JSON &value);
+
+    void startObject(size_t size);
+
+    void key(const char *data, size_t size);
+
+    void startArray(size_t size);
+
+    void string(const char *data, size_t size);
+
+    void null();
+
+    void boolean(bool value);
+
+    void integer(long long value);
+
+    void unsignedInteger(unsigned long long value);
+
+    void real(double value);
+
+    // Sends the buffered output to the sink
+    void flush();
+
+private:
+    std::string ownBuffer;
+    std::string &out;
+    JSONSink *sink;
+    BinaryFormat format;
+
+    // CBOR initial byte and argument, in as few bytes as the argument fits in
+    void head(unsigned char major, unsigned long long value);
+
+    void bigEndian(unsigned long long value, int bytes);
+
+    void endValue();
+};
+
+// Reads one CBOR or MessagePack value from [data, end) and reports it to handler like
+// ParseEvents does for text, so memory use does not depend on the size of the input.
+// data is moved past the value, so a stream of values can be read one after the other.
+// Byte strings are reported as strings, other keys than strings and integers are rejected.
+// Returns false if the handler stopped early or the input is malformed.
+bool ParseBinaryEvents(const char *&data, const char *end, BinaryFormat format, JSONHandler &handler);
+
+// Same, building the tree. Gives an invalid JSON for malformed input.
+JSON ParseBinary(const char *&data, const char *end, BinaryFormat format);
+
+}  // namespace autojson
+
+#ifndef autojsonuselib
+#include "autojson_src/Binary.cpp"
+#endif
+
+#endif // AUTOJSON_BINARY_HPP
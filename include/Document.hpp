@@ -0,0 +1,70 @@
+#ifndef AUTOJSON_DOCUMENT_HPP
+#define AUTOJSON_DOCUMENT_HPP
+
+#include <string>
+
+#include "Arena.hpp"
+#include "JSON.hpp"
+
+namespace autojson {
+
+// A parsed JSON tree that lives entirely inside the document's own arena.
+// Nothing in the tree is freed on its own: destroying, clearing or re-parsing
+// the document releases all of it at once. The tree is read-only; copy a
+// value out of it (which allocates on the heap) to modify it.
+//
+// Example:
+//  JSONDocument doc;
+//  const JSON& request = doc.parse(body);
+//  int id = request["id"];
+class JSONDocument {
+public:
+    JSONDocument() { }
+
+    explicit JSONDocument(size_t blockSize) : memory(blockSize) { }
+
+    // Parses into a caller-owned buffer first and only grows onto the heap when it is too small
+    JSONDocument(void *buffer, size_t size) : memory(buffer, size) { }
+
+    ~JSONDocument();
+
+    JSONDocument(const JSONDocument&) = delete;
+    JSONDocument& operator=(const JSONDocument&) = delete;
+
+    // Replaces the current tree with the one read from content
+    const JSON& parse(const char *&content);
+
+    const JSON& parse(const std::string &content);
+
+    // Uses the structural index backend, see JSON::parseIndexed
+    const JSON& parseIndexed(const char *content, size_t size);
+
+    const JSON& parseIndexed(const std::string &content);
+
+    // See JSON::tryParse; the root is invalid when the input is not
+    const JSON& tryParse(const char *content, size_t size, ParseResult &result);
+
+    const JSON& tryParse(const std::string &content, ParseResult &result);
+
+    const JSON& root() const {
+        return this->rootNode;
+    }
+
+    const Arena& arena() const {
+        return this->memory;
+    }
+
+    void clear();
+
+private:
+    Arena memory;
+    JSON rootNode;
+};
+
+}  // namespace autojson
+
+#ifndef autojsonuselib
+#include "autojson_src/Document.cpp"
+#endif
+
+#endif // AUTOJSON_DOCUMENT_HPP
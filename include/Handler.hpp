@@ -0,0 +1,71 @@
+#ifndef AUTOJSON_HANDLER_HPP
+#define AUTOJSON_HANDLER_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace autojson {
+
+// Receives the events of ParseEvents, in document order, without any tree being built.
+// Every method returns false to stop parsing early. The defaults ignore the event, so a
+// handler only overrides what it is interested in. Text arguments are only valid during the call.
+//
+// Example:
+//  struct SumScores : JSONHandler {
+//      bool inScore = false;
+//      double sum = 0;
+//      bool key(const char *data, size_t size) override {
+//          inScore = (size == 5 and memcmp(data, "score", 5) == 0);
+//          return true;
+//      }
+//      bool real(double value) override {
+//          sum += inScore ? value : 0;
+//          return true;
+//      }
+//  };
+class JSONHandler {
+public:
+    virtual ~JSONHandler() { }
+
+    virtual bool startObject() { return true; }
+
+    // Name of the next value of the current object
+    virtual bool key(const char * /*data*/, size_t /*size*/) { return true; }
+
+    virtual bool endObject() { return true; }
+
+    virtual bool startArray() { return true; }
+
+    virtual bool endArray() { return true; }
+
+    virtual bool string(const char * /*data*/, size_t /*size*/) { return true; }
+
+    virtual bool null() { return true; }
+
+    virtual bool boolean(bool /*value*/) { return true; }
+
+    virtual bool integer(long long /*value*/) { return true; }
+
+    // Only for integers too big for a long long
+    virtual bool unsignedInteger(unsigned long long /*value*/) { return true; }
+
+    virtual bool real(double /*value*/) { return true; }
+
+    // Bare words that are neither numbers nor literals
+    virtual bool raw(const char * /*data*/, size_t /*size*/) { return true; }
+};
+
+// Reads one value from content like JSON::parse does, but reports it to handler piece by piece.
+// Memory use does not depend on the size of the input, only on the length of its longest string.
+// Returns false if the handler stopped early or the input is malformed.
+bool ParseEvents(const char *&content, JSONHandler &handler);
+
+bool ParseEvents(const std::string &content, JSONHandler &handler);
+
+}  // namespace autojson
+
+#ifndef autojsonuselib
+#include "autojson_src/Handler.cpp"
+#endif
+
+#endif // AUTOJSON_HANDLER_HPP
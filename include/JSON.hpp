@@ -7,10 +7,16 @@
 #include <string>
 #include <vector>
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "Arena.hpp"
 
 namespace autojson {
 
-enum JSONType {
+enum JSONType : unsigned char {
     INVALID,
     PRIMITIVE,
     STRING,
@@ -29,44 +35,145 @@ inline std::string JSONTypeToString(JSONType t) {
     }
 }
 
-class StringifyPart;
+// What a PRIMITIVE node holds. Everything except RAW is stored inline in the node,
+// RAW keeps the textual form of a primitive that is not a valid JSON literal
+// (inline when it is short enough).
+enum JSONPrimitiveType : unsigned char {
+    RAW,
+    NULL_VALUE,
+    BOOLEAN,
+    INTEGER,
+    UNSIGNED,
+    REAL
+};
+
+// Order in which the keys of an object are kept, and so iterated and written
+enum JSONKeyOrder : unsigned char {
+    SORTED_KEYS,
+    INSERTION_ORDER
+};
+
+// Why JSON::tryParse stopped
+enum JSONParseStatus : unsigned char {
+    PARSE_OK,
+    PARSE_UNEXPECTED_EOF,
+    PARSE_UNEXPECTED_CHARACTER,
+    PARSE_EXPECTED_KEY,
+    PARSE_EXPECTED_COLON,
+    // something other than separators after the document
+    PARSE_TRAILING_CHARACTERS,
+    // containers nested deeper than 1024
+    PARSE_TOO_DEEP,
+    // 4GB or more
+    PARSE_TOO_LARGE
+};
+
+inline const char* ParseStatusToString(JSONParseStatus status) {
+    switch (status) {
+        case PARSE_OK:                      return "ok";
+        case PARSE_UNEXPECTED_EOF:          return "unexpected end of input";
+        case PARSE_UNEXPECTED_CHARACTER:    return "unexpected character";
+        case PARSE_EXPECTED_KEY:            return "expected a key";
+        case PARSE_EXPECTED_COLON:          return "expected ':'";
+        case PARSE_TRAILING_CHARACTERS:     return "unexpected character after the end of the document";
+        case PARSE_TOO_DEEP:                return "nested too deep";
+        case PARSE_TOO_LARGE:               return "input too large";
+        default:                            return "unknown";
+    }
+}
+
+struct ParseResult {
+    JSONParseStatus status = PARSE_OK;
+    // byte of the input where the error was found; the size of the input when it ended too soon
+    size_t offset = 0;
+
+    bool ok() const {
+        return this->status == PARSE_OK;
+    }
+
+    const char* message() const {
+        return ParseStatusToString(this->status);
+    }
+};
+
+class BinaryDecoder;
+class BinaryWriter;
+class JSONBuilder;
+class JSONDocument;
+class JSONFrozen;
+class JSONObject;
+class JSONPath;
+class JSONView;
+class JSONWriter;
+class SnapshotWriter;
+
+// Object key that is hashed and interned once, then reused for lookups in many objects.
+// Parsed objects share the interned copy of their keys, so a lookup by JSONKey usually
+// only compares pointers.
+//
+// Example:
+//  static const JSON::Key kUserId("userId");
+//  long long id = request[kUserId];
+class JSONKey {
+public:
+    explicit JSONKey(std::string_view key);
+
+    const char* data() const {
+        return this->ptr;
+    }
+
+    size_t size() const {
+        return this->length;
+    }
+
+    uint32_t hash() const {
+        return this->keyHash;
+    }
+
+    operator std::string_view() const {
+        return std::string_view(this->ptr, this->length);
+    }
+
+private:
+    const char *ptr;
+    uint32_t length;
+    uint32_t keyHash;
+};
 
 class JSON {
 public:
+    typedef JSONKey Key;
+    // Containers take their memory from an arena when the document was parsed into one
+    typedef std::vector<JSON, ArenaAllocator<JSON>> Vector;
+    typedef JSONObject Object;
+    typedef JSONPath Path;
+
     JSONType type;
-    void *content;
 
-    JSON() : type(JSONType::INVALID), content(nullptr) { }
+    JSON() : type(JSONType::INVALID), primitive(JSONPrimitiveType::RAW), flags(0), inlineSize(0) { }
 
     JSON(JSONType type);
 
-    // takes ownership of pointer
-    JSON(JSONType type, void *content) : type(type), content(content) { }
-
     // STL constructors
-    JSON(const std::string &c) : type(JSONType::STRING), content(new std::string(c)) { }
-    JSON(const char *c) : type(JSONType::STRING), content(new std::string(c)) { }
-
+    JSON(const std::string &c) : JSON(c.data(), c.size()) { }
+    JSON(const char *c);
+    JSON(const char *c, size_t size) : type(JSONType::STRING), primitive(JSONPrimitiveType::RAW), flags(0), inlineSize(0) {
+        this->setText(c, size);
+    }
 
     template<typename Type>
-    JSON(const std::vector<Type> &els) : type(JSONType::VECTOR) {
-        auto v = new std::vector<JSON>;
-
+    JSON(const std::vector<Type> &els) : JSON(JSONType::VECTOR) {
+        this->vector->reserve(els.size());
         for (const Type& itr : els) {
-            v->emplace_back(JSON(itr));
+            this->vector->emplace_back(JSON(itr));
         }
-
-        this->content = v;
     }
 
     template<typename T>
-    JSON(const std::map<std::string, T> &els) : type(JSONType::OBJECT) {
-        auto m = new std::map<std::string, JSON>;
-
+    JSON(const std::map<std::string, T> &els) : JSON(JSONType::OBJECT) {
         for (const auto& itr : els) {
-            (*m)[itr.first] = JSON(itr.second);
+            (*this)[itr.first] = JSON(itr.second);
         }
-        this->content = m;
     }
 
     // std initializer constructor - does good things
@@ -78,9 +185,9 @@ public:
 
     JSON& operator=(const JSON&);
 
-    JSON(JSON&&);
+    JSON(JSON&&) noexcept;
 
-    JSON& operator=(JSON&&);
+    JSON& operator=(JSON&&) noexcept;
 
     // If the JSON is invalid (just declared or it's not in a map)
     // The | operator will give it a valid for easier use when writing deserialize specialised methods
@@ -110,51 +217,103 @@ public:
 
     static JSON parse(const std::string &content);
 
+    // Same result as parse(), but finds the quotes and structural characters of the whole
+    // input with SIMD kernels first and builds the tree from their offsets. Much faster on
+    // big inputs; always reads the whole input instead of stopping after the first value.
+    static JSON parseIndexed(const char *content, size_t size);
+
+    static JSON parseIndexed(const std::string &content);
+
+    // Same parser as parseIndexed(), for input that cannot be trusted: never prints, never calls
+    // the fatal error callback and never reads outside [content, content + size). Stops at the
+    // first error and gives an invalid JSON, with result telling what and where.
+    // Stricter than parse(), it checks that
+    //  - bare words are null, true, false or numbers, without a leading + or leading zeros
+    //  - strings and keys are in double quotes
+    //  - values, and entries of objects, are separated by exactly one comma, with none before
+    //    the first or after the last, and only whitespace is anywhere else between tokens
+    //  - nothing but whitespace follows the document, and containers nest at most 1024 deep
+    // It does not check escapes, which are kept as written except \" and \', nor control
+    // characters in strings. Like parse(), a ' inside a string ends it, so such strings fail.
+    // Keys are interned only when they already were, never added to the key table.
+    static JSON tryParse(const char *content, size_t size, ParseResult &result);
+
+    static JSON tryParse(const std::string &content, ParseResult &result);
+
     static JSON readFromFile(const std::string &file_name);
 
     // Serialize API
     std::string stringify(int shrink=true) const;
 
-    void stringify(StringifyPart part) const;
+    // Appends to output, so a buffer cleared between documents is reused
+    void stringify(std::string &output, bool shrink=true) const;
+
+    // Same values in CBOR (RFC 8949) or MessagePack, see BinaryWriter in Binary.hpp.
+    // The from* functions give an invalid JSON for malformed input.
+    std::string toCBOR() const;
+
+    void toCBOR(std::string &output) const;
+
+    static JSON fromCBOR(const char *data, size_t size);
+
+    static JSON fromCBOR(const std::string &data);
+
+    std::string toMessagePack() const;
+
+    void toMessagePack(std::string &output) const;
+
+    static JSON fromMessagePack(const char *data, size_t size);
+
+    static JSON fromMessagePack(const std::string &data);
 
     /// primitive
 
-    void stringifyPrimitive(StringifyPart part) const;
+    // a primitive whose value is kept as text, exactly as it was read
+    static JSON rawPrimitive(const char *text, size_t size);
+
+    JSONPrimitiveType primitiveType() const {
+        return this->primitive;
+    }
 
     // if the JSON is invalid and not const, it will change type
     // to the converted value and assign it with a default value
     // * 0 for numbers and empty for the other
     // better than throwing an exception
+    JSON(std::nullptr_t) : JSON(JSONPrimitiveType::NULL_VALUE) { }
+
     operator bool() const;
-    JSON(bool b) : type(PRIMITIVE), content(new std::string(b ? "true" : "false")) { }
+    JSON(bool b) : JSON(JSONPrimitiveType::BOOLEAN) { this->boolean = b; }
 
     operator int() const;
-    JSON(int i) : type(PRIMITIVE), content(new std::string(std::to_string(i))) { }
+    JSON(int i) : JSON(JSONPrimitiveType::INTEGER) { this->integer = i; }
 
     operator long() const;
-    JSON(long l) : type(PRIMITIVE), content(new std::string(std::to_string(l))) { }
+    JSON(long l) : JSON(JSONPrimitiveType::INTEGER) { this->integer = l; }
 
     operator unsigned long() const;
-    JSON(unsigned long ul) : type(PRIMITIVE), content(new std::string(std::to_string(ul))) { }
+    JSON(unsigned long ul) : JSON(JSONPrimitiveType::UNSIGNED) { this->unsignedInteger = ul; }
 
     operator long long() const;
-    JSON(long long ll) : type(PRIMITIVE), content(new std::string(std::to_string(ll))) { }
+    JSON(long long ll) : JSON(JSONPrimitiveType::INTEGER) { this->integer = ll; }
 
     operator unsigned long long() const;
-    JSON(unsigned long long ull) : type(PRIMITIVE), content(new std::string(std::to_string(ull))) { }
+    JSON(unsigned long long ull) : JSON(JSONPrimitiveType::UNSIGNED) { this->unsignedInteger = ull; }
 
     operator float() const;
-    JSON(float f) : type(PRIMITIVE), content(new std::string(std::to_string(f))) { }
+    // keeps the shortest decimal value of f, so JSON(0.1f) is written as 0.1
+    JSON(float f);
 
     operator double() const;
-    JSON(double d) : type(PRIMITIVE), content(new std::string(std::to_string(d))) { }
+    JSON(double d) : JSON(JSONPrimitiveType::REAL) { this->real = d; }
 
     operator long double() const;
-    JSON(long double ld) : type(PRIMITIVE), content(new std::string(std::to_string(ld))) { }
+    JSON(long double ld) : JSON(JSONPrimitiveType::REAL) { this->real = (double)ld; }
 
     template<class T>
     JSON(const std::atomic<T> &o) : JSON((T)o) {}
 
+    // Number checks only look at the primitive type decided when the value was created
+    bool isNull() const;
     bool isInteger() const;
     bool isReal() const;
     bool isBool() const;
@@ -168,38 +327,47 @@ public:
     bool isArray() const;
     bool isObject() const;
 
-    bool isInteger(const std::string& key) const;
-    bool isReal(const std::string& key) const;
-    bool isBool(const std::string& key) const;
-    bool isHex(const std::string& key) const;
-    bool isHex16(const std::string& key) const;
-    bool isHex32(const std::string& key) const;
-    bool isHex64(const std::string& key) const;
-    bool isHex128(const std::string& key) const;
-
-    bool isString(const std::string& key) const;
-    bool isArray(const std::string& key) const;
-    bool isObject(const std::string& key) const;
-
-    bool exists(const std::string& key) const;
-    void set(const std::string& key, const JSON& value);
-    JSON& getOrSet(const std::string& key, const JSON& defaultValue = JSON());
-    JSON get(const std::string& key, const JSON& defaultValue = JSON()) const;
+    bool isNull(std::string_view key) const;
+    bool isInteger(std::string_view key) const;
+    bool isReal(std::string_view key) const;
+    bool isBool(std::string_view key) const;
+    bool isHex(std::string_view key) const;
+    bool isHex16(std::string_view key) const;
+    bool isHex32(std::string_view key) const;
+    bool isHex64(std::string_view key) const;
+    bool isHex128(std::string_view key) const;
+
+    bool isString(std::string_view key) const;
+    bool isArray(std::string_view key) const;
+    bool isObject(std::string_view key) const;
+
+    bool exists(std::string_view key) const;
+    void set(std::string_view key, const JSON& value);
+    JSON& getOrSet(std::string_view key, const JSON& defaultValue = JSON());
+    // Copies the value (in O(1) when it is shared), use find() or operator[] to only look at it
+    JSON get(std::string_view key, const JSON& defaultValue = JSON()) const;
+
+    // Value stored under key, or nullptr when it is missing or this is not an object
+    const JSON* find(std::string_view key) const;
+    const JSON* find(const Key &key) const;
+
+    // Value at the end of path, or nullptr when it is not there. See JSONPath.
+    const JSON* find(const Path &path) const;
 
     // string
 
-    void stringifyString(StringifyPart part) const;
-
     operator std::string() const;
 
     // vector
 
     static JSON parseVector(const char *&content);
 
-    void stringifyVector(StringifyPart part) const;
-
     JSON& operator[](int key);
 
+    // Read-only access never inserts: out of range indices report an error
+    // and give back an invalid JSON.
+    const JSON& operator[](int key) const;
+
     template<typename Type>
     operator std::vector<Type>() const {
         this->checkType(JSONType::VECTOR);
@@ -211,16 +379,16 @@ public:
     }
 
     // for for-based loops
-    std::vector<JSON>::iterator begin();
-    std::vector<JSON>::const_iterator begin() const;
+    Vector::iterator begin();
+    Vector::const_iterator begin() const;
 
-    std::vector<JSON>::iterator end();
-    std::vector<JSON>::const_iterator end() const;
+    Vector::iterator end();
+    Vector::const_iterator end() const;
 
     template<typename Type>
     JSON& push_back(const Type &rhs) {
         this->checkTypeAndSetIfInvalid(JSONType::VECTOR);
-        auto& v = *(std::vector<JSON>*)(this->content);
+        auto& v = *this->vector;
         v.push_back(rhs);
         return v.back();
     }
@@ -228,14 +396,14 @@ public:
     template<typename Type>
     JSON& emplace_back(Type &&rhs) {
         this->checkTypeAndSetIfInvalid(JSONType::VECTOR);
-        auto& v = *(std::vector<JSON>*)(this->content);
+        auto& v = *this->vector;
         v.emplace_back(rhs);
         return v.back();
     }
 
     void pop_back() {
         this->checkTypeAndSetIfInvalid(JSONType::VECTOR);
-        auto& v = *(std::vector<JSON>*)(this->content);
+        auto& v = *this->vector;
         v.pop_back();
     }
 
@@ -244,20 +412,39 @@ public:
     // object
     static JSON parseObject(const char *&content);
 
-    void stringifyObject(StringifyPart part) const;
-
     JSON& operator[](const std::string &key);
     JSON& operator[](const char *key);
+    JSON& operator[](std::string_view key);
+    JSON& operator[](const Key &key);
 
+    // Missing keys give back an invalid JSON instead of inserting one
+    const JSON& operator[](const std::string &key) const;
+    const JSON& operator[](const char *key) const;
+    const JSON& operator[](std::string_view key) const;
+    const JSON& operator[](const Key &key) const;
 
+    JSONKeyOrder keyOrder() const;
+
+    // Switching to SORTED_KEYS sorts the keys; switching to INSERTION_ORDER keeps the current order
+    void setKeyOrder(JSONKeyOrder order);
+
+    // defined in Object.hpp
     template<typename Type>
-    operator std::map<std::string, Type>() const {
-        std::map<std::string, Type> m;
-        auto& mp = *(std::map<std::string, JSON>*)(content);
-        for (const auto& itr : mp) {
-            m[itr.first] = (Type)(itr.second);
-        }
-        return m;
+    operator std::map<std::string, Type>() const;
+
+    // Switches the whole subtree to shared payloads with atomic reference counts: copies of
+    // it, or of any part of it, then cost O(1) and can be read from any thread. The first
+    // write to a copy only copies the nodes on the path to the change. Parts added later
+    // are not shared until share() is called again.
+    // Do not write through references taken into a shared value before it was copied.
+    void share();
+
+    // Immutable copy in one block of memory, which any number of threads can read without
+    // locking. Declared in Snapshot.hpp, include it to use this.
+    JSONFrozen freeze() const;
+
+    bool shared() const {
+        return this->flags & SHARED;
     }
 
     // Helper functions.
@@ -267,35 +454,79 @@ public:
     bool valid() const {
         return type != INVALID;
     }
-};
-
-inline std::ostream& operator<<(std::ostream &os, const JSON &JSON) {
-    os << JSON.stringify();
-    return os;
-}
 
-class StringifyPart {
-public:
-    std::string& result;
-    int indentLevel;
-    bool shrink;
-    bool continueLine;
-
-    StringifyPart(std::string& result, int indentLevel, bool shrink, bool continueLine)
-            : result(result), indentLevel(indentLevel), shrink(shrink), continueLine(continueLine) {
+    // Character data of a STRING or a RAW primitive, wherever it is stored.
+    const char* textData() const {
+        return (this->flags & INLINE_TEXT) ? this->inlineText : this->text.data;
     }
 
-    StringifyPart increaseIndent();
-
-    StringifyPart isContinueLine();
-
-    StringifyPart& indent(int bonus = 0);
+    size_t textSize() const {
+        return (this->flags & INLINE_TEXT) ? this->inlineSize : this->text.size;
+    }
 
-    StringifyPart& endLine();
+private:
+    friend class BinaryDecoder;
+    friend class BinaryWriter;
+    friend class JSONBuilder;
+    friend class JSONView;
+    friend class JSONWriter;
+    friend class SnapshotWriter;
+
+    // Strings up to this size live inside the node instead of on the heap
+    static const size_t kInlineTextCapacity = 16;
+
+    enum Flags : unsigned char {
+        INLINE_TEXT = 1,
+        // the payload lives in an arena and is released together with it
+        ARENA = 2,
+        // the payload is reference counted and only written to while this node is its only owner
+        SHARED = 4
+    };
+
+    struct HeapText {
+        char *data;
+        size_t size;
+    };
+
+    JSONPrimitiveType primitive;
+    unsigned char flags;
+    unsigned char inlineSize;
+
+    // Which member is active is decided by type, primitive and flags.
+    // Only arrays, objects and long strings own heap memory.
+    union {
+        bool boolean;
+        long long integer;
+        unsigned long long unsignedInteger;
+        double real;
+        char inlineText[kInlineTextCapacity];
+        HeapText text;
+        Vector *vector;
+        Object *object;
+    };
+
+    explicit JSON(JSONPrimitiveType primitive) : type(JSONType::PRIMITIVE), primitive(primitive), flags(0), inlineSize(0), integer(0) { }
+
+    void setText(const char *data, size_t size);
+
+    void release();
+
+    // The heap payload (array, object or text) of the node
+    void* payload() const;
+
+    // Gives a shared node a payload of its own before it is written to
+    void unshare();
+
+    // steals rhs's payload without releasing this one and leaves rhs invalid
+    void takeFrom(JSON &rhs) noexcept;
 
-    StringifyPart& deleteComma();
+    template<typename T>
+    T toNumber() const;
 };
 
+// Streams the shrunk JSON without building it in a string first
+std::ostream& operator<<(std::ostream &os, const JSON &json);
+
 typedef void(*FatalErrorCallback)(const std::string&);
 
 FatalErrorCallback& GetFatalErrorCallback();
@@ -304,4 +535,7 @@ void SetFatalErrorCallback(FatalErrorCallback callback);
 
 }  // namespace autojson
 
+#include "Object.hpp"
+#include "Path.hpp"
+
 #endif // AUTOJSON_JSON
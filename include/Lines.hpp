@@ -0,0 +1,123 @@
+#ifndef AUTOJSON_LINES_HPP
+#define AUTOJSON_LINES_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "JSON.hpp"
+#include "Writer.hpp"
+
+namespace autojson {
+
+// Order in which a JSONLinesReader hands out documents
+enum JSONLinesOrder : unsigned char {
+    // The order of the input
+    INPUT_ORDER,
+    // Each chunk as soon as it is parsed. Lines of a chunk stay in order.
+    ANY_ORDER
+};
+
+// Reads NDJSON / JSON Lines: one document per line, blank lines skipped.
+// The input is cut into chunks on line boundaries and the chunks are parsed by a pool of
+// workers, so throughput grows with the number of cores. Workers find the boundaries of
+// their own chunks, nothing looks at the whole input first. At most a few chunks per worker
+// are parsed ahead of the one being handed out, so memory stays flat for any input size.
+//
+// Example:
+//  JSONLinesReader logs(8);
+//  logs.open("requests.ndjson");
+//  logs.read([&](size_t offset, JSON &request) {
+//      latencies.push_back(request["latency"]);
+//      return true;
+//  });
+class JSONLinesReader {
+public:
+    // Called with the byte offset of the line in the input, which also orders the documents.
+    // Returning false stops reading.
+    typedef std::function<bool(size_t offset, JSON &value)> Handle;
+
+    // Input is parsed in chunks of about this many bytes
+    static const size_t kChunkSize = 1 << 20;
+
+    // jobs workers parse the input, 0 uses as many as there are cores
+    explicit JSONLinesReader(unsigned jobs = 0);
+
+    ~JSONLinesReader();
+
+    JSONLinesReader(const JSONLinesReader&) = delete;
+    JSONLinesReader& operator=(const JSONLinesReader&) = delete;
+
+    // Maps the file, which is read straight from the page cache
+    bool open(const std::string &file_name);
+
+    // Uses input that is already in memory. It must outlive this.
+    void open(const char *data, size_t size);
+
+    void close();
+
+    // Parses the input and calls handle for every document, always on the calling thread.
+    // Returns the number of documents handed out.
+    size_t read(const Handle &handle, JSONLinesOrder order = INPUT_ORDER);
+
+    // Every document, in the order of the input
+    std::vector<JSON> readAll();
+
+    void setChunkSize(size_t size) {
+        this->chunkSize = size > 0 ? size : 1;
+    }
+
+private:
+    const char *content;
+    size_t contentSize;
+    bool mapped;
+
+    unsigned jobs;
+    size_t chunkSize;
+
+    // [begin, end) of chunk, from the first line starting in it to the end of its last line
+    void chunkBounds(size_t chunk, size_t &begin, size_t &end) const;
+};
+
+// Writes documents one per line. A batch is split across a pool of workers that serialize
+// their parts at the same time, and the parts are written out in order.
+//
+// Example:
+//  FileDescriptorSink out(fd);
+//  JSONLinesWriter lines(out);
+//  lines.write(events);
+class JSONLinesWriter {
+public:
+    // Appends to output
+    explicit JSONLinesWriter(std::string &output, unsigned jobs = 0);
+
+    explicit JSONLinesWriter(JSONSink &sink, unsigned jobs = 0);
+
+    JSONLinesWriter(const JSONLinesWriter&) = delete;
+    JSONLinesWriter& operator=(const JSONLinesWriter&) = delete;
+
+    void write(const JSON &value);
+
+    void write(const JSON *values, size_t count);
+
+    void write(const std::vector<JSON> &values) {
+        this->write(values.data(), values.size());
+    }
+
+private:
+    std::string *output;
+    JSONSink *sink;
+    unsigned jobs;
+
+    // serialized parts of the last batch, kept to reuse their memory
+    std::vector<std::string> parts;
+};
+
+}  // namespace autojson
+
+#ifndef autojsonuselib
+#include "autojson_src/Lines.cpp"
+#endif
+
+#endif // AUTOJSON_LINES_HPP
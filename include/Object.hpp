@@ -0,0 +1,177 @@
+#ifndef AUTOJSON_OBJECT_HPP
+#define AUTOJSON_OBJECT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Arena.hpp"
+#include "JSON.hpp"
+
+namespace autojson {
+
+// Order of the objects created from now on, SORTED_KEYS unless changed
+JSONKeyOrder& GetDefaultKeyOrder();
+
+void SetDefaultKeyOrder(JSONKeyOrder order);
+
+uint32_t HashKey(const char *key, size_t size);
+
+// Storage of a JSON object: the entries sit next to each other in one array, which is
+// scanned directly while the object is small. Bigger objects also get an open-addressing
+// hash index over that array, so lookups stay O(1) without chasing tree nodes.
+// Keys point into the process-wide key table when they could be interned there; only
+// the others are allocated with the object.
+// Like with a std::vector, adding a key can move the values: references taken before
+// an insertion must not be used after it.
+// With SORTED_KEYS, slot() adds keys at the end and they are sorted in only when the
+// entries are next iterated, so building an object one key at a time stays linear.
+class JSONObject {
+public:
+    struct Entry {
+        const char *keyData;
+        uint32_t keySize : 31;
+        // keyData was allocated for this entry instead of interned
+        uint32_t ownsKey : 1;
+        // HashKey(key), compared before the bytes of the key
+        uint32_t hash;
+        JSON value;
+
+        Entry(const char *keyData, size_t keySize, bool ownsKey, uint32_t hash)
+            : keyData(keyData), keySize((uint32_t)keySize), ownsKey(ownsKey), hash(hash) { }
+
+        std::string_view key() const {
+            return std::string_view(this->keyData, this->keySize);
+        }
+    };
+
+    typedef ArenaAllocator<Entry> allocator_type;
+    typedef std::vector<Entry, allocator_type> Entries;
+    typedef Entries::iterator iterator;
+    typedef Entries::const_iterator const_iterator;
+
+    // Up to this many entries a lookup compares keys one by one
+    static const size_t kLinearScanLimit = 16;
+
+    explicit JSONObject(JSONKeyOrder order = GetDefaultKeyOrder(), const allocator_type &allocator = allocator_type())
+        : entries(allocator), index(IndexAllocator(allocator)), keyOrder(order), sortedCount(0), unsorted(false) { }
+
+    // The copy is on the heap, like copies of any container of an arena
+    JSONObject(const JSONObject &rhs);
+
+    JSONObject(JSONObject &&rhs);
+
+    JSONObject& operator=(const JSONObject&) = delete;
+
+    ~JSONObject();
+
+    size_t size() const {
+        return this->entries.size();
+    }
+
+    bool empty() const {
+        return this->entries.empty();
+    }
+
+    iterator begin() { this->sortKeys(); return this->entries.begin(); }
+    iterator end() { this->sortKeys(); return this->entries.end(); }
+    const_iterator begin() const { this->sortKeys(); return this->entries.begin(); }
+    const_iterator end() const { this->sortKeys(); return this->entries.end(); }
+
+    allocator_type get_allocator() const {
+        return this->entries.get_allocator();
+    }
+
+    JSONKeyOrder order() const {
+        return this->keyOrder;
+    }
+
+    // Switching to SORTED_KEYS sorts the entries; switching away keeps their current order
+    void setOrder(JSONKeyOrder order);
+
+    // hash must be HashKey(key)
+    JSON* find(std::string_view key, uint32_t hash);
+
+    const JSON* find(std::string_view key, uint32_t hash) const;
+
+    // Value stored under key, inserted as invalid when missing
+    JSON& slot(std::string_view key, uint32_t hash);
+
+    void reserve(size_t size) {
+        this->entries.reserve(size);
+    }
+
+    // Adds an entry without looking for the key first. Meant for filling a whole object
+    // at once: call finish() afterwards to put the keys in order and merge duplicates.
+    // Without internNewKeys, only keys already in the key table are shared: for untrusted
+    // input, which must not fill the table with keys of its own.
+    JSON& append(std::string_view key, bool internNewKeys = true);
+
+    // When a key was appended more than once, the last value wins
+    void finish();
+
+private:
+    // position + 1 of an entry, 0 for an empty slot
+    struct Slot {
+        uint32_t position;
+        uint32_t hash;
+    };
+
+    typedef ArenaAllocator<Slot> IndexAllocator;
+
+    Entries entries;
+    std::vector<Slot, IndexAllocator> index;
+    JSONKeyOrder keyOrder;
+    // with SORTED_KEYS, the first sortedCount entries are in order and unsorted is set while
+    // slot() added others after them
+    size_t sortedCount;
+    std::atomic<bool> unsorted;
+
+    static const size_t npos = (size_t)-1;
+
+    // Puts the keys added by slot() in order. Readers of a const object may call it from
+    // several threads, so the check is atomic and the sort itself is done by only one of them.
+    void sortKeys() const {
+        if (this->unsorted.load(std::memory_order_acquire)) {
+            this->sortAdded();
+        }
+    }
+
+    void sortAdded() const;
+
+    // Position of key among the first count entries, which must all be in the index
+    size_t position(std::string_view key, uint32_t hash, size_t count) const;
+
+    // Interns key, or copies it with the allocator of the object when it cannot be interned
+    void emplaceEntry(iterator position, std::string_view key, uint32_t hash, bool internNewKeys = true);
+
+    void releaseKey(Entry &entry);
+
+    // Indexes the entry at position, the index then covering count entries
+    void insertIntoIndex(size_t position, size_t count);
+
+    // Indexes the first count entries, or drops the index while that is few enough to scan
+    void rebuildIndex(size_t count);
+};
+
+template<typename Type>
+JSON::operator std::map<std::string, Type>() const {
+    this->checkType(JSONType::OBJECT);
+    std::map<std::string, Type> m;
+    for (const auto& itr : *this->object) {
+        m[std::string(itr.key())] = (Type)(itr.value);
+    }
+    return m;
+}
+
+}  // namespace autojson
+
+#ifndef autojsonuselib
+#include "autojson_src/Object.cpp"
+#endif
+
+#endif // AUTOJSON_OBJECT_HPP
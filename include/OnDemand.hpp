@@ -0,0 +1,169 @@
+#ifndef AUTOJSON_ON_DEMAND_HPP
+#define AUTOJSON_ON_DEMAND_HPP
+
+#include <string>
+#include <string_view>
+
+#include "JSON.hpp"
+#include "Reader.hpp"
+
+namespace autojson {
+
+class JSONLazyArray;
+class JSONLazyDocument;
+class JSONLazyObject;
+
+// Value of a JSONLazyDocument. It only remembers where it starts in the input, and is parsed
+// each time it is read, so it is cheap to copy and costs nothing until then.
+// Reading it the wrong way is reported like JSONReader does and gives a default value.
+class JSONLazyValue {
+public:
+    JSONLazyValue() : start(nullptr), document(nullptr) { }
+
+    // Told by the first character, without reading the value
+    JSONType type() const;
+
+    bool valid() const {
+        return this->type() != JSONType::INVALID;
+    }
+
+    bool isNull() const;
+
+    // Empty when the value is invalid, so lookups can be chained past a missing key
+    JSONLazyObject object() const;
+
+    JSONLazyArray array() const;
+
+    // Looks key up from the start of the object. Use object().find() for more than one key.
+    JSONLazyValue operator[](std::string_view key) const;
+    JSONLazyValue operator[](const std::string &key) const;
+    JSONLazyValue operator[](const char *key) const;
+
+    // Element at index of an array, skipping the ones before it
+    JSONLazyValue operator[](int index) const;
+
+    // Points into the input, or into the document when the string has escapes. Then it is
+    // only valid until the next call to text() on the same document.
+    std::string_view text() const;
+
+    operator std::string() const;
+
+    operator bool() const;
+    operator int() const;
+    operator long() const;
+    operator unsigned long() const;
+    operator long long() const;
+    operator unsigned long long() const;
+    operator float() const;
+    operator double() const;
+    operator long double() const;
+
+    // The whole value as a tree
+    JSON toJSON() const;
+
+private:
+    friend class JSONLazyArray;
+    friend class JSONLazyDocument;
+    friend class JSONLazyObject;
+
+    const char *start;
+    JSONLazyDocument *document;
+
+    JSONLazyValue(const char *start, JSONLazyDocument *document);
+
+    template<typename T>
+    T number() const {
+        T value = T(0);
+        if (this->start != nullptr) {
+            JSONReader(this->start).readNumber(value);
+        }
+        return value;
+    }
+};
+
+// Forward-only cursor over the entries of an object. Values are only skipped when the
+// cursor moves past them, so reading a value and then moving on goes over it twice.
+//
+// Example:
+//  JSONLazyObject user = doc.root()["user"].object();
+//  std::string name = user.find("name");
+//  int age = user.find("age");
+class JSONLazyObject {
+public:
+    // Moves to the next entry, false at the end of the object. key is valid until the next call.
+    bool next(std::string_view &key, JSONLazyValue &value);
+
+    // Looks for key from the current entry to the end of the object, then from its start back
+    // to where the search began. Keys asked for in the order of the input take one pass.
+    // Gives an invalid value when key is missing.
+    JSONLazyValue find(std::string_view key);
+
+private:
+    friend class JSONLazyValue;
+
+    JSONReader reader;
+    const char *start;
+    JSONLazyDocument *document;
+    // the reader is on the value of the last entry, which still has to be skipped
+    bool pending;
+    bool finished;
+
+    JSONLazyObject(const char *start, JSONLazyDocument *document);
+
+    void restart();
+};
+
+// Forward-only cursor over the elements of an array
+class JSONLazyArray {
+public:
+    // Moves to the next element, false at the end of the array
+    bool next(JSONLazyValue &value);
+
+private:
+    friend class JSONLazyValue;
+
+    JSONReader reader;
+    JSONLazyDocument *document;
+    bool pending;
+    bool finished;
+
+    JSONLazyArray(const char *start, JSONLazyDocument *document);
+};
+
+// Document parsed on demand: it keeps the input and only parses the values that are read,
+// jumping over the others with a quote- and bracket-aware scan that decodes nothing. The
+// cost of reading a few fields follows the bytes in front of them instead of the size of
+// the document. The input must be NUL terminated and outlive the document.
+//
+// Example:
+//  JSONLazyDocument doc(body);
+//  long long id = doc.root()["id"];
+//  std::string_view status = doc.root()["status"].text();
+class JSONLazyDocument {
+public:
+    explicit JSONLazyDocument(const char *content) : content(content) { }
+
+    explicit JSONLazyDocument(const std::string &content) : JSONLazyDocument(content.c_str()) { }
+
+    JSONLazyDocument(const JSONLazyDocument&) = delete;
+    JSONLazyDocument& operator=(const JSONLazyDocument&) = delete;
+
+    JSONLazyValue root() {
+        return JSONLazyValue(this->content, this);
+    }
+
+private:
+    friend class JSONLazyValue;
+
+    const char *content;
+    // unescaped strings given out by text()
+    std::string buffer;
+};
+
+}  // namespace autojson
+
+#ifndef autojsonuselib
+#include "autojson_src/OnDemand.cpp"
+#endif
+
+#endif // AUTOJSON_ON_DEMAND_HPP
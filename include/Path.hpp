@@ -0,0 +1,71 @@
+#ifndef AUTOJSON_PATH_HPP
+#define AUTOJSON_PATH_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "JSON.hpp"
+
+namespace autojson {
+
+// Path to a value deep inside a JSON, read once from an RFC 6901 JSON Pointer and then
+// followed as often as needed. Keys are interned like JSON::Key and array indices are parsed
+// up front, so following the path only does the lookups: it never allocates, copies or
+// inserts, and gives nullptr when the value is not there.
+// A token made of digits matches an array index as well as an object key.
+//
+// Example:
+//  static const JSON::Path kRps("/config/limits/rps");
+//  const JSON *rps = request.find(kRps);
+//  int limit = rps != nullptr ? (int)*rps : 100;
+class JSONPath {
+public:
+    // The whole document
+    JSONPath() : ok(true) { }
+
+    // A malformed pointer is reported with JSONError and gives a path that finds nothing
+    explicit JSONPath(std::string_view pointer);
+
+    // Goes one level further, key and index being taken as they are
+    JSONPath& key(std::string_view key);
+
+    JSONPath& index(size_t index);
+
+    bool valid() const {
+        return this->ok;
+    }
+
+    // Number of levels
+    size_t size() const {
+        return this->steps.size();
+    }
+
+    // Back to RFC 6901 text, escaped
+    std::string pointer() const;
+
+    const JSON* find(const JSON &root) const;
+
+private:
+    // the token as an array index, when it is one
+    static const size_t kNoIndex = (size_t)-1;
+
+    struct Step {
+        JSON::Key key;
+        size_t index;
+    };
+
+    std::vector<Step> steps;
+    bool ok;
+
+    void addToken(std::string_view token);
+};
+
+}  // namespace autojson
+
+#ifndef autojsonuselib
+#include "autojson_src/Path.cpp"
+#endif
+
+#endif // AUTOJSON_PATH_HPP
@@ -0,0 +1,110 @@
+#ifndef AUTOJSON_PUSH_HPP
+#define AUTOJSON_PUSH_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Handler.hpp"
+#include "JSON.hpp"
+
+namespace autojson {
+
+class PushTree;
+
+// Parser that is handed the input piece by piece, as it arrives from the network, instead of
+// reading it from one NUL terminated buffer. Pieces can be cut anywhere, even inside a string,
+// an escape or a number: only a token cut in two is copied, everything else is read where it
+// is. Same grammar as JSON::parse, and the document is complete as soon as its last byte is fed.
+// The tree is built like JSON::parse builds it, or the events are sent to a JSONHandler.
+//
+// Example:
+//  JSONPushParser parser;
+//  while (not parser.done() and connection.read(chunk)) {
+//      parser.feed(chunk.data(), chunk.size());
+//  }
+//  JSON request = parser.result();
+class JSONPushParser {
+public:
+    // Builds a JSON, given by result()
+    JSONPushParser();
+
+    // Sends the events to handler instead
+    explicit JSONPushParser(JSONHandler &handler);
+
+    ~JSONPushParser();
+
+    JSONPushParser(const JSONPushParser&) = delete;
+    JSONPushParser& operator=(const JSONPushParser&) = delete;
+
+    // Reads the next piece of the input. Returns false once the input is malformed or the
+    // handler stopped; the rest is then ignored until reset().
+    bool feed(const char *data, size_t size);
+
+    bool feed(const std::string &data);
+
+    // Ends the input. Only a document that is a bare word, like a number, needs it to be done.
+    // Returns false if the document is not complete.
+    bool finish();
+
+    bool done() const {
+        return this->state == DONE;
+    }
+
+    bool failed() const {
+        return this->state == FAILED;
+    }
+
+    // Takes the document out once done(), invalid before that
+    JSON result();
+
+    // Gets ready for another document, keeping the memory of this one
+    void reset();
+
+private:
+    enum State : unsigned char {
+        BEFORE_VALUE,
+        BEFORE_KEY,
+        BEFORE_COLON,
+        IN_STRING,
+        IN_WORD,
+        DONE,
+        FAILED
+    };
+
+    std::unique_ptr<PushTree> tree;
+    JSONHandler *handler;
+
+    State state;
+    // '{' and '[' of the containers around the current value
+    std::vector<char> containers;
+    // the string being read is a key
+    bool inKey;
+    // the last character fed was a backslash inside a string
+    bool escaped;
+    // the start of the current token was fed before, and is in buffer
+    bool pending;
+    std::string buffer;
+    // bytes fed before the current piece, for error messages
+    size_t offset;
+
+    const char* readString(const char *p, const char *end);
+
+    const char* readWord(const char *p, const char *end);
+
+    // Moves on after a complete value
+    void endValue();
+
+    bool fail(const char *message, size_t position);
+
+    bool stop();
+};
+
+}  // namespace autojson
+
+#ifndef autojsonuselib
+#include "autojson_src/Push.cpp"
+#endif
+
+#endif // AUTOJSON_PUSH_HPP
@@ -0,0 +1,144 @@
+#ifndef AUTOJSON_READER_HPP
+#define AUTOJSON_READER_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "JSON.hpp"
+
+namespace autojson {
+
+// Hashes behind the generated read() functions. For every class, autojson-bin picks a seed
+// for which the field names land in distinct slots, so a key is matched with one hash and
+// one compare. NameHash only looks at the size and the first and last bytes, which is
+// enough to tell apart the names of most classes; FullNameHash is used for the others.
+// Changing either changes the generated code.
+constexpr uint32_t NameHash(const char *data, size_t size, uint32_t seed) {
+    uint32_t hash = (uint32_t)size << 16;
+    if (size) {
+        hash ^= ((uint32_t)(unsigned char)data[0] << 8) ^ (unsigned char)data[size - 1];
+    }
+    hash = (hash ^ seed) * 0x9E3779B1u;
+    return hash ^ (hash >> 16);
+}
+
+constexpr uint32_t FullNameHash(const char *data, size_t size, uint32_t seed) {
+    uint32_t hash = seed ^ (uint32_t)size;
+    for (size_t i = 0; i < size; i += 1) {
+        hash = (hash ^ (unsigned char)data[i]) * 16777619u;
+    }
+    return hash ^ (hash >> 15);
+}
+
+// Pull parser for code that knows the shape it expects, like the read() functions
+// autojson-bin generates: the caller asks for an object, a key, an array element or a
+// value, and the reader parses just that, straight from the input. Values nobody asks
+// for are skipped without being decoded. Same grammar as JSON::parse.
+// Malformed input, and input that is not what the caller asked for, is reported with
+// ParseError. The reader stops there: ok() turns false and every call after that returns
+// false or an invalid JSON.
+//
+// Example:
+//  JSONReader reader(content);
+//  std::string_view key;
+//  if (reader.startObject()) {
+//      while (reader.nextKey(key)) {
+//          if (key == "id") {
+//              reader.readNumber(id);
+//          } else {
+//              reader.skipValue();
+//          }
+//      }
+//  }
+class JSONReader {
+public:
+    // content must be NUL terminated and outlive the reader
+    explicit JSONReader(const char *content) : content(content), failed(false) { }
+
+    explicit JSONReader(const std::string &content) : JSONReader(content.c_str()) { }
+
+    bool ok() const {
+        return not this->failed;
+    }
+
+    // Where the next value starts
+    const char* position() const {
+        return this->content;
+    }
+
+    // Consumes the '{' of an object. A null is consumed too but returns false, like anything
+    // else that is not an object (which is also reported, and stops the reader).
+    bool startObject();
+
+    // Reads the next key of the object and the ':' after it, or consumes the '}' and returns
+    // false. key stays valid until the next call to the reader.
+    bool nextKey(std::string_view &key);
+
+    // Same as startObject, for the '[' of an array
+    bool startArray();
+
+    // True when another element follows, false after consuming the ']'
+    bool nextElement();
+
+    // Moves past the next value without decoding it
+    void skipValue();
+
+    // The next string, number, boolean or null as a JSON node, which does not allocate for
+    // numbers. Objects and arrays are reported.
+    JSON readScalar();
+
+    // Numbers, booleans and nulls, converted like the JSON conversion operators do.
+    // Anything else is reported and leaves value unchanged.
+    template<typename T>
+    void readNumber(T &value) {
+        JSON scalar = this->readScalar();
+        if (scalar.type == JSONType::PRIMITIVE and scalar.primitiveType() != JSONPrimitiveType::RAW) {
+            value = (T)scalar;
+        } else if (scalar.valid()) {
+            this->unexpected("a number");
+        }
+    }
+
+    // Strings are unescaped straight into value, other scalars keep their text
+    void readString(std::string &value);
+
+    // When the next value is a string, reads it into name like nextKey does and returns true.
+    // Otherwise reads nothing.
+    bool readName(std::string_view &name);
+
+    // When the next value is null, consumes it and returns true. Otherwise reads nothing.
+    bool readNull();
+
+    // The next value as a whole tree. It is built by the same parser as JSON::tryParse, with
+    // the grammar of JSON::parse: nesting is limited and the first error stops the reader.
+    JSON readValue();
+
+    // Reports that the value just read is not what the caller expected, and stops the reader
+    void unexpected(const char *expected);
+
+private:
+    const char *content;
+    bool failed;
+    std::string buffer;
+
+    // Whitespace and commas, which the grammar treats as whitespace
+    void skipSeparators();
+
+    // Consumes '{' or '[', see startObject
+    bool startContainer(char open, const char *name);
+
+    // Reads the string at content into [data, data + size), pointing into the input when it
+    // has no escapes and into buffer otherwise
+    bool readRawString(const char *&data, size_t &size);
+
+    void fail(const char *message);
+};
+
+}  // namespace autojson
+
+#ifndef autojsonuselib
+#include "autojson_src/Reader.cpp"
+#endif
+
+#endif // AUTOJSON_READER_HPP
@@ -0,0 +1,287 @@
+#ifndef AUTOJSON_SERIALIZE_HPP
+#define AUTOJSON_SERIALIZE_HPP
+
+#include <cstring>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "JSON.hpp"
+#include "Reader.hpp"
+#include "Writer.hpp"
+
+namespace autojson {
+
+// write(writer, value) streams a value straight into a JSONWriter without building a JSON
+// first. autojson-bin generates an overload for every class it reads; these cover the
+// types those classes are made of.
+//
+// Example:
+//  std::string out;
+//  JSONWriter writer(out);
+//  write(writer, plot);
+
+inline void write(JSONWriter &writer, bool value) {
+    writer.boolean(value);
+}
+
+inline void write(JSONWriter &writer, int value) {
+    writer.integer(value);
+}
+
+inline void write(JSONWriter &writer, long value) {
+    writer.integer(value);
+}
+
+inline void write(JSONWriter &writer, long long value) {
+    writer.integer(value);
+}
+
+inline void write(JSONWriter &writer, unsigned int value) {
+    writer.unsignedInteger(value);
+}
+
+inline void write(JSONWriter &writer, unsigned long value) {
+    writer.unsignedInteger(value);
+}
+
+inline void write(JSONWriter &writer, unsigned long long value) {
+    writer.unsignedInteger(value);
+}
+
+inline void write(JSONWriter &writer, float value) {
+    // written with the shortest digits of the float, like JSON(float)
+    writer.write(JSON(value));
+}
+
+inline void write(JSONWriter &writer, double value) {
+    writer.real(value);
+}
+
+inline void write(JSONWriter &writer, long double value) {
+    writer.real((double)value);
+}
+
+// null like other pointers when there is no string
+inline void write(JSONWriter &writer, const char *value) {
+    if (value == nullptr) {
+        writer.null();
+    } else {
+        writer.string(value, std::strlen(value));
+    }
+}
+
+inline void write(JSONWriter &writer, std::string_view value) {
+    writer.string(value.data(), value.size());
+}
+
+inline void write(JSONWriter &writer, const std::string &value) {
+    writer.string(value.data(), value.size());
+}
+
+inline void write(JSONWriter &writer, const JSON &value) {
+    writer.write(value);
+}
+
+template<typename T>
+void write(JSONWriter &writer, const T *value) {
+    if (value == nullptr) {
+        writer.null();
+    } else {
+        write(writer, *value);
+    }
+}
+
+template<typename T>
+void write(JSONWriter &writer, const std::vector<T> &values) {
+    writer.startArray();
+    for (const auto &itr : values) {
+        write(writer, itr);
+    }
+    writer.endArray();
+}
+
+template<typename T>
+void write(JSONWriter &writer, const std::map<std::string, T> &values) {
+    writer.startObject();
+    for (const auto &itr : values) {
+        writer.key(itr.first.data(), itr.first.size());
+        write(writer, itr.second);
+    }
+    writer.endObject();
+}
+
+// read(reader, value) is the other way around: it parses the next value of a JSONReader
+// straight into value. Keys that are missing from the input leave their field unchanged.
+//
+// Example:
+//  GraphPlot plot;
+//  if (not ParseInto(content, plot)) { ... }
+
+inline void read(JSONReader &reader, bool &value) {
+    reader.readNumber(value);
+}
+
+// Integers narrower than a long long go through one, so numbers that do not fit are
+// reported instead of being cut down to their low bits
+template<typename T>
+void ReadInteger(JSONReader &reader, T &value) {
+    typedef typename std::conditional<std::is_signed<T>::value, long long, unsigned long long>::type Wide;
+    Wide number = value;
+    reader.readNumber(number);
+    bool fits = number <= (Wide)std::numeric_limits<T>::max();
+    if constexpr (std::is_signed<T>::value) {
+        fits = fits and number >= (Wide)std::numeric_limits<T>::min();
+    }
+    if (not fits) {
+        reader.unexpected("a number in the range of the field");
+        return;
+    }
+    value = (T)number;
+}
+
+// char and the fixed size integers are numbers, like write() gives them
+inline void read(JSONReader &reader, char &value) {
+    ReadInteger(reader, value);
+}
+
+inline void read(JSONReader &reader, signed char &value) {
+    ReadInteger(reader, value);
+}
+
+inline void read(JSONReader &reader, unsigned char &value) {
+    ReadInteger(reader, value);
+}
+
+inline void read(JSONReader &reader, short &value) {
+    ReadInteger(reader, value);
+}
+
+inline void read(JSONReader &reader, unsigned short &value) {
+    ReadInteger(reader, value);
+}
+
+inline void read(JSONReader &reader, int &value) {
+    ReadInteger(reader, value);
+}
+
+inline void read(JSONReader &reader, long &value) {
+    ReadInteger(reader, value);
+}
+
+inline void read(JSONReader &reader, long long &value) {
+    reader.readNumber(value);
+}
+
+inline void read(JSONReader &reader, unsigned int &value) {
+    ReadInteger(reader, value);
+}
+
+inline void read(JSONReader &reader, unsigned long &value) {
+    ReadInteger(reader, value);
+}
+
+inline void read(JSONReader &reader, unsigned long long &value) {
+    reader.readNumber(value);
+}
+
+inline void read(JSONReader &reader, float &value) {
+    reader.readNumber(value);
+}
+
+inline void read(JSONReader &reader, double &value) {
+    reader.readNumber(value);
+}
+
+inline void read(JSONReader &reader, long double &value) {
+    reader.readNumber(value);
+}
+
+inline void read(JSONReader &reader, std::string &value) {
+    reader.readString(value);
+}
+
+inline void read(JSONReader &reader, JSON &value) {
+    value = reader.readValue();
+}
+
+// null resets the pointer, without deleting what it pointed to. Anything else is read through
+// it, into a new T when it was null: the class that holds the pointer then owns that T.
+template<typename T>
+void read(JSONReader &reader, T *&value) {
+    if (reader.readNull()) {
+        value = nullptr;
+        return;
+    }
+
+    typedef typename std::remove_const<T>::type Value;
+    if constexpr (std::is_const<T>::value) {
+        // what a pointer to const points to is not ours to change, read into a copy instead
+        Value *copy = value != nullptr ? new Value(*value) : new Value();
+        read(reader, *copy);
+        value = copy;
+    } else {
+        if (value == nullptr) {
+            value = new Value();
+        }
+        read(reader, *value);
+    }
+}
+
+// The string is copied into a new NUL terminated array, which the class then owns
+inline void read(JSONReader &reader, const char *&value) {
+    if (reader.readNull()) {
+        value = nullptr;
+        return;
+    }
+
+    std::string text;
+    reader.readString(text);
+    if (reader.ok()) {
+        char *copy = new char[text.size() + 1];
+        std::memcpy(copy, text.c_str(), text.size() + 1);
+        value = copy;
+    }
+}
+
+// Elements are parsed in place. The vector is cleared but keeps its capacity, so reading
+// into the same object again does not reallocate.
+template<typename T>
+void read(JSONReader &reader, std::vector<T> &values) {
+    values.clear();
+    if (not reader.startArray()) {
+        return;
+    }
+    while (reader.nextElement()) {
+        values.emplace_back();
+        read(reader, values.back());
+    }
+}
+
+template<typename T>
+void read(JSONReader &reader, std::map<std::string, T> &values) {
+    values.clear();
+    if (not reader.startObject()) {
+        return;
+    }
+    std::string_view key;
+    while (reader.nextKey(key)) {
+        read(reader, values[std::string(key)]);
+    }
+}
+
+// Parses content into value without building a JSON. False when the input is malformed,
+// in which case value holds whatever was read before the error.
+template<typename T>
+bool ParseInto(const std::string &content, T &value) {
+    JSONReader reader(content);
+    read(reader, value);
+    return reader.ok();
+}
+
+}  // namespace autojson
+
+#endif // AUTOJSON_SERIALIZE_HPP
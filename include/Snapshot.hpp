@@ -0,0 +1,236 @@
+#ifndef AUTOJSON_SNAPSHOT_HPP
+#define AUTOJSON_SNAPSHOT_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "JSON.hpp"
+
+namespace autojson {
+
+struct SnapshotNode;
+
+// Read-only value inside a JSONSnapshot. It only points into the snapshot, so it is cheap to
+// copy and must not outlive it. Lookups behave like the const ones of JSON: missing keys give
+// an invalid view, type mismatches and out of range indices are reported with JSONError.
+class JSONView {
+public:
+    // Walks the elements of an array or the values of an object
+    class iterator {
+    public:
+        JSONView operator*() const;
+
+        // Key of the current entry of an object
+        std::string_view key() const;
+
+        iterator& operator++() {
+            this->position += this->stride;
+            return *this;
+        }
+
+        bool operator==(const iterator &rhs) const {
+            return this->position == rhs.position;
+        }
+
+        bool operator!=(const iterator &rhs) const {
+            return this->position != rhs.position;
+        }
+
+    private:
+        friend class JSONView;
+
+        const char *base;
+        size_t limit;
+        const char *position;
+        size_t stride;
+
+        iterator(const char *base, size_t limit, const char *position, size_t stride)
+            : base(base), limit(limit), position(position), stride(stride) { }
+    };
+
+    JSONView() : base(nullptr), limit(0), node(nullptr) { }
+
+    JSONType type() const;
+
+    JSONPrimitiveType primitiveType() const;
+
+    bool valid() const {
+        return this->node != nullptr and this->type() != JSONType::INVALID;
+    }
+
+    bool isNull() const;
+    bool isInteger() const;
+    bool isReal() const;
+    bool isBool() const;
+
+    bool isString() const;
+    bool isArray() const;
+    bool isObject() const;
+
+    // Entries of an array or an object
+    int size() const;
+
+    // Element of an array, or value of the entry at index of an object
+    JSONView operator[](int index) const;
+
+    // Value of key, invalid when this is not an object or has no such key
+    JSONView operator[](std::string_view key) const;
+    JSONView operator[](const std::string &key) const;
+    JSONView operator[](const char *key) const;
+
+    bool exists(std::string_view key) const;
+
+    // Key of the entry at index of an object
+    std::string_view key(int index) const;
+
+    iterator begin() const;
+
+    iterator end() const;
+
+    // Characters of a string or a RAW primitive, without copying them out of the snapshot
+    std::string_view text() const;
+
+    operator bool() const;
+    operator int() const;
+    operator long() const;
+    operator unsigned long() const;
+    operator long long() const;
+    operator unsigned long long() const;
+    operator float() const;
+    operator double() const;
+    operator long double() const;
+
+    operator std::string() const;
+
+    // Copy of the value on the heap, to change it or to hand it to code that takes a JSON
+    JSON toJSON() const;
+
+private:
+    friend class JSONFrozen;
+    friend class JSONSnapshot;
+
+    const char *base;
+    size_t limit;
+    const SnapshotNode *node;
+
+    JSONView(const char *base, size_t limit, const SnapshotNode *node) : base(base), limit(limit), node(node) { }
+
+    void checkType(JSONType type) const;
+
+    // bytes at offset of the snapshot, or nullptr when they are not all inside of it
+    const char* at(unsigned long long offset, size_t bytes) const;
+
+    // entries of the container, checked like at()
+    const char* children(size_t bytes) const;
+
+    // value stored under key, nullptr when it is missing
+    const SnapshotNode* find(std::string_view key) const;
+
+    template<typename T>
+    T toNumber() const;
+};
+
+// A JSON tree in a flat, position independent format that is used right where it lies:
+// open() maps the file read-only instead of reading and parsing it. Opening takes the same
+// time whatever the size of the file, pages are only read once they are touched, and the
+// processes that open the same file share one copy of it through the page cache.
+// Snapshots depend on the byte order of the machine that wrote them and on the version of
+// the format, and open() refuses the others.
+//
+// Example:
+//  JSONSnapshot::writeToFile(reference, "reference.snap");
+//  ...
+//  JSONSnapshot snapshot;
+//  if (snapshot.open("reference.snap")) {
+//      int limit = snapshot.root()["limits"]["requests"];
+//  }
+class JSONSnapshot {
+public:
+    JSONSnapshot() : content(nullptr), contentSize(0), mapped(false) { }
+
+    ~JSONSnapshot();
+
+    JSONSnapshot(const JSONSnapshot&) = delete;
+    JSONSnapshot& operator=(const JSONSnapshot&) = delete;
+
+    // Appends the snapshot of value to output
+    static void write(const JSON &value, std::string &output);
+
+    static std::string write(const JSON &value);
+
+    // The snapshot is written next to file_name and renamed over it, so processes that mapped
+    // the previous one keep reading it unchanged
+    static bool writeToFile(const JSON &value, const std::string &file_name);
+
+    bool open(const std::string &file_name);
+
+    // Uses a snapshot that is already in memory. It must be 8-byte aligned and outlive this.
+    bool open(const char *data, size_t size);
+
+    void close();
+
+    // Invalid when nothing is open
+    JSONView root() const;
+
+private:
+    const char *content;
+    size_t contentSize;
+    bool mapped;
+
+    // Checks the header of the snapshot, not its content
+    bool check();
+};
+
+// Immutable copy of a JSON made by JSON::freeze(): a snapshot kept in memory. It is one block
+// that is only ever read and holds no lazy state, so any number of threads read it at the
+// same time without locks, and reading it never allocates or copies. There is nothing to
+// write through. Copies share the block, which is freed with the last of them.
+//
+// Example:
+//  static const JSONFrozen config = JSON::readFromFile("config.json").freeze();
+//  ...
+//  // on any thread
+//  int rps = config["limits"]["rps"];
+class JSONFrozen {
+public:
+    // Invalid root
+    JSONFrozen() { }
+
+    explicit JSONFrozen(const JSON &value);
+
+    JSONView root() const;
+
+    JSONView operator[](int index) const {
+        return this->root()[index];
+    }
+
+    JSONView operator[](std::string_view key) const {
+        return this->root()[key];
+    }
+
+    JSONView operator[](const std::string &key) const {
+        return this->root()[key];
+    }
+
+    JSONView operator[](const char *key) const {
+        return this->root()[key];
+    }
+
+    // Bytes of the block
+    size_t size() const {
+        return this->content != nullptr ? this->content->size() : 0;
+    }
+
+private:
+    std::shared_ptr<const std::string> content;
+};
+
+}  // namespace autojson
+
+#ifndef autojsonuselib
+#include "autojson_src/Snapshot.cpp"
+#endif
+
+#endif // AUTOJSON_SNAPSHOT_HPP
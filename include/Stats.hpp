@@ -0,0 +1,54 @@
+#ifndef AUTOJSON_STATS_HPP
+#define AUTOJSON_STATS_HPP
+
+#include "JSON.hpp"
+
+namespace autojson {
+
+// What the library counts when it is built with AUTOJSON_STATS defined (the AUTOJSON_STATS
+// CMake option). Without it nothing is counted and the counting code is not even compiled.
+enum JSONCounter : unsigned char {
+    // heap payloads of nodes: containers, and text too long to be stored in the node
+    NODES_ALLOCATED,
+    NODES_FREED,
+    // input of the text parsers
+    BYTES_PARSED,
+    // output of stringify, and of operator<< and the other writers to a JSONSink
+    BYTES_EMITTED,
+    // numbers and booleans read out of nodes
+    NUMBER_CONVERSIONS,
+    // keys looked up in objects, by find() and operator[]
+    KEY_LOOKUPS,
+    // of those, the keys that were not there; operator[] then adds them
+    KEY_MISSES,
+    // containers copied node by node instead of shared, by copy construction or operator=
+    DEEP_COPIES,
+    COUNTER_COUNT
+};
+
+enum JSONTimer : unsigned char {
+    PARSE_TIME,
+    STRINGIFY_TIME,
+    TIMER_COUNT
+};
+
+// Whether the library was built with AUTOJSON_STATS
+bool StatsEnabled();
+
+// Every thread counts on its own, without locks, and this sums all of them, including the
+// threads that already ended. Latencies are histograms with power of two buckets, each
+// keyed by its upper bound in nanoseconds:
+//  {"counters": {"nodesAllocated": 120, ...},
+//   "latency": {"parse": {"count": 3, "totalNs": 5200, "buckets": {"2048": 2, "4096": 1}}, ...}}
+JSON GetStats();
+
+// Counts start again from zero, for every thread
+void ResetStats();
+
+}  // namespace autojson
+
+#ifndef autojsonuselib
+#include "autojson_src/Stats.cpp"
+#endif
+
+#endif // AUTOJSON_STATS_HPP
@@ -0,0 +1,129 @@
+#ifndef AUTOJSON_WRITER_HPP
+#define AUTOJSON_WRITER_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+namespace autojson {
+
+class JSON;
+
+// Where a JSONWriter sends its output
+class JSONSink {
+public:
+    virtual ~JSONSink() { }
+
+    virtual void write(const char *data, size_t size) = 0;
+};
+
+class StreamSink : public JSONSink {
+public:
+    explicit StreamSink(std::ostream &os) : os(os) { }
+
+    void write(const char *data, size_t size) override;
+
+private:
+    std::ostream &os;
+};
+
+// Writes to a POSIX file descriptor; the descriptor is not closed
+class FileDescriptorSink : public JSONSink {
+public:
+    explicit FileDescriptorSink(int fd) : fd(fd) { }
+
+    void write(const char *data, size_t size) override;
+
+private:
+    int fd;
+};
+
+// Serializes in a single forward pass: separators and indentation are written before each
+// value, never patched afterwards, and the tree is only read, never copied.
+// Values are either whole trees (write) or built piece by piece with the event methods,
+// which take the same events as a JSONHandler.
+//
+// Example:
+//  std::string out;
+//  JSONWriter writer(out);
+//  writer.startObject();
+//  writer.key("id", 2);
+//  writer.integer(1);
+//  writer.endObject();
+class JSONWriter {
+public:
+    // Output is buffered and handed to the sink in chunks of about this size
+    static const size_t kFlushSize = 16 * 1024;
+
+    // Appends to output, without any intermediate buffer. Clearing and reusing the same
+    // string for every document avoids allocating once it has grown big enough.
+    explicit JSONWriter(std::string &output, bool shrink = true);
+
+    explicit JSONWriter(JSONSink &sink, bool shrink = true);
+
+    // Flushes whatever is still buffered
+    ~JSONWriter();
+
+    JSONWriter(const JSONWriter&) = delete;
+    JSONWriter& operator=(const JSONWriter&) = delete;
+
+    void write(const JSON &value);
+
+    void startObject();
+
+    void key(const char *data, size_t size);
+
+    // Key that is already escaped, like the field names in generated code
+    void escapedKey(const char *data, size_t size);
+
+    void endObject();
+
+    void startArray();
+
+    void endArray();
+
+    void string(const char *data, size_t size);
+
+    void null();
+
+    void boolean(bool value);
+
+    void integer(long long value);
+
+    void unsignedInteger(unsigned long long value);
+
+    void real(double value);
+
+    // Text written as is, without quotes
+    void raw(const char *data, size_t size);
+
+    // Sends the buffered output to the sink
+    void flush();
+
+private:
+    std::string ownBuffer;
+    std::string &out;
+    JSONSink *sink;
+
+    bool shrink;
+    int depth;
+    bool needComma;
+    bool afterKey;
+
+    // separator, new line and indentation in front of a value
+    void beginValue();
+
+    void endValue();
+
+    void newLine(int indentLevel);
+
+    void escaped(const char *data, size_t size);
+};
+
+}  // namespace autojson
+
+#ifndef autojsonuselib
+#include "autojson_src/Writer.cpp"
+#endif
+
+#endif // AUTOJSON_WRITER_HPP
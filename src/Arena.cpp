@@ -0,0 +1,75 @@
+#include "Arena.hpp"
+
+#include <cstdlib>
+
+namespace autojson {
+
+Arena::Arena(size_t blockSize)
+    : current(nullptr), end(nullptr), blocks(nullptr), blockSize(blockSize), used(0),
+      userBuffer(nullptr), userBufferSize(0) {
+}
+
+Arena::Arena(void *buffer, size_t size)
+    : current((char*)buffer), end((char*)buffer + size), blocks(nullptr), blockSize(kDefaultBlockSize), used(0),
+      userBuffer(buffer), userBufferSize(size) {
+}
+
+Arena::~Arena() {
+    while (this->blocks != nullptr) {
+        Block *next = this->blocks->next;
+        std::free(this->blocks);
+        this->blocks = next;
+    }
+}
+
+void* Arena::allocateSlow(size_t size, size_t alignment) {
+    // grow geometrically so a big document needs few blocks
+    size_t needed = sizeof(Block) + size + alignment;
+    size_t capacity = this->blockSize;
+    if (this->blocks != nullptr and this->blocks->size * 2 > capacity) {
+        capacity = this->blocks->size * 2;
+    }
+    if (capacity < needed) {
+        capacity = needed;
+    }
+
+    Block *block = (Block*)std::malloc(capacity);
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    block->next = this->blocks;
+    block->size = capacity;
+    this->blocks = block;
+
+    this->current = (char*)block + sizeof(Block);
+    this->end = (char*)block + capacity;
+    return this->allocate(size, alignment);
+}
+
+void Arena::release() {
+    Block *largest = nullptr;
+    while (this->blocks != nullptr) {
+        Block *next = this->blocks->next;
+        if (largest == nullptr or this->blocks->size > largest->size) {
+            std::free(largest);
+            largest = this->blocks;
+        } else {
+            std::free(this->blocks);
+        }
+        this->blocks = next;
+    }
+
+    this->used = 0;
+    if (largest != nullptr and largest->size > this->userBufferSize) {
+        largest->next = nullptr;
+        this->blocks = largest;
+        this->current = (char*)largest + sizeof(Block);
+        this->end = (char*)largest + largest->size;
+    } else {
+        std::free(largest);
+        this->current = (char*)this->userBuffer;
+        this->end = (char*)this->userBuffer + this->userBufferSize;
+    }
+}
+
+}  // namespace autojson
@@ -0,0 +1,821 @@
+#include "Binary.hpp"
+
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+#include "Error.hpp"
+#include "Format.hpp"
+
+namespace autojson {
+
+namespace {
+
+// Containers nested deeper than this are rejected instead of recursing further
+const int kMaxBinaryDepth = 1024;
+
+// true if a float holds value exactly, so 4 bytes are enough for it
+bool FitsFloat(double value) {
+    if (std::isnan(value)) {
+        return true;
+    }
+    if (std::isfinite(value) and std::fabs(value) > FLT_MAX) {
+        return false;
+    }
+    return (double)(float)value == value;
+}
+
+// IEEE 754 half precision, as in the appendix of RFC 8949
+double HalfToDouble(unsigned long long half) {
+    int exponent = (half >> 10) & 0x1f;
+    int mantissa = half & 0x3ff;
+    double value;
+    if (exponent == 0) {
+        value = std::ldexp(mantissa, -24);
+    } else if (exponent != 31) {
+        value = std::ldexp(mantissa + 1024, exponent - 25);
+    } else {
+        value = mantissa == 0 ? INFINITY : NAN;
+    }
+    return (half & 0x8000) ? -value : value;
+}
+
+}  // namespace
+
+BinaryWriter::BinaryWriter(std::string &output, BinaryFormat format)
+    : out(output), sink(nullptr), format(format) {
+}
+
+BinaryWriter::BinaryWriter(JSONSink &sink, BinaryFormat format)
+    : out(ownBuffer), sink(&sink), format(format) {
+    this->ownBuffer.reserve(kFlushSize + kFlushSize / 4);
+}
+
+BinaryWriter::~BinaryWriter() {
+    this->flush();
+}
+
+void BinaryWriter::flush() {
+    if (this->sink != nullptr and not this->out.empty()) {
+        this->sink->write(this->out.data(), this->out.size());
+        this->out.clear();
+    }
+}
+
+void BinaryWriter::write(const JSON &value) {
+    switch (value.type) {
+        case JSONType::PRIMITIVE:
+            switch (value.primitiveType()) {
+                case JSONPrimitiveType::NULL_VALUE:
+                    this->null();
+                    break;
+                case JSONPrimitiveType::BOOLEAN:
+                    this->boolean(value.boolean);
+                    break;
+                case JSONPrimitiveType::INTEGER:
+                    this->integer(value.integer);
+                    break;
+                case JSONPrimitiveType::UNSIGNED:
+                    this->unsignedInteger(value.unsignedInteger);
+                    break;
+                case JSONPrimitiveType::REAL:
+                    this->real(value.real);
+                    break;
+                default:
+                    this->string(value.textData(), value.textSize());
+            }
+            break;
+        case JSONType::STRING:
+            this->string(value.textData(), value.textSize());
+            break;
+        case JSONType::VECTOR:
+            this->startArray(value.vector->size());
+            for (const JSON &itr : *value.vector) {
+                this->write(itr);
+            }
+            break;
+        case JSONType::OBJECT:
+            this->startObject(value.object->size());
+            for (const auto &itr : *value.object) {
+                this->key(itr.keyData, itr.keySize);
+                this->write(itr.value);
+            }
+            break;
+        default:
+            JSONError("Cannot encode an invalid JSON");
+    }
+}
+
+void BinaryWriter::startObject(size_t size) {
+    if (this->format == CBOR) {
+        this->head(5, size);
+    } else if (size < 16) {
+        this->out += (char)(0x80 | size);
+    } else if (size <= 0xffff) {
+        this->out += (char)0xde;
+        this->bigEndian(size, 2);
+    } else {
+        this->out += (char)0xdf;
+        this->bigEndian(size, 4);
+    }
+    this->endValue();
+}
+
+void BinaryWriter::key(const char *data, size_t size) {
+    this->string(data, size);
+}
+
+void BinaryWriter::startArray(size_t size) {
+    if (this->format == CBOR) {
+        this->head(4, size);
+    } else if (size < 16) {
+        this->out += (char)(0x90 | size);
+    } else if (size <= 0xffff) {
+        this->out += (char)0xdc;
+        this->bigEndian(size, 2);
+    } else {
+        this->out += (char)0xdd;
+        this->bigEndian(size, 4);
+    }
+    this->endValue();
+}
+
+void BinaryWriter::string(const char *data, size_t size) {
+    if (this->format == CBOR) {
+        this->head(3, size);
+    } else if (size < 32) {
+        this->out += (char)(0xa0 | size);
+    } else if (size <= 0xff) {
+        this->out += (char)0xd9;
+        this->bigEndian(size, 1);
+    } else if (size <= 0xffff) {
+        this->out += (char)0xda;
+        this->bigEndian(size, 2);
+    } else {
+        this->out += (char)0xdb;
+        this->bigEndian(size, 4);
+    }
+    this->out.append(data, size);
+    this->endValue();
+}
+
+void BinaryWriter::null() {
+    this->out += (char)(this->format == CBOR ? 0xf6 : 0xc0);
+    this->endValue();
+}
+
+void BinaryWriter::boolean(bool value) {
+    if (this->format == CBOR) {
+        this->out += (char)(value ? 0xf5 : 0xf4);
+    } else {
+        this->out += (char)(value ? 0xc3 : 0xc2);
+    }
+    this->endValue();
+}
+
+void BinaryWriter::integer(long long value) {
+    if (value >= 0) {
+        this->unsignedInteger(value);
+        return;
+    }
+
+    if (this->format == CBOR) {
+        // major type 1 holds -1 - n
+        this->head(1, (unsigned long long)(-(value + 1)));
+    } else if (value >= -32) {
+        this->out += (char)value;
+    } else if (value >= INT8_MIN) {
+        this->out += (char)0xd0;
+        this->bigEndian(value, 1);
+    } else if (value >= INT16_MIN) {
+        this->out += (char)0xd1;
+        this->bigEndian(value, 2);
+    } else if (value >= INT32_MIN) {
+        this->out += (char)0xd2;
+        this->bigEndian(value, 4);
+    } else {
+        this->out += (char)0xd3;
+        this->bigEndian(value, 8);
+    }
+    this->endValue();
+}
+
+void BinaryWriter::unsignedInteger(unsigned long long value) {
+    if (this->format == CBOR) {
+        this->head(0, value);
+    } else if (value < 0x80) {
+        this->out += (char)value;
+    } else if (value <= 0xff) {
+        this->out += (char)0xcc;
+        this->bigEndian(value, 1);
+    } else if (value <= 0xffff) {
+        this->out += (char)0xcd;
+        this->bigEndian(value, 2);
+    } else if (value <= 0xffffffff) {
+        this->out += (char)0xce;
+        this->bigEndian(value, 4);
+    } else {
+        this->out += (char)0xcf;
+        this->bigEndian(value, 8);
+    }
+    this->endValue();
+}
+
+void BinaryWriter::real(double value) {
+    if (FitsFloat(value)) {
+        float single = (float)value;
+        uint32_t bits;
+        memcpy(&bits, &single, sizeof(bits));
+        this->out += (char)(this->format == CBOR ? 0xfa : 0xca);
+        this->bigEndian(bits, 4);
+    } else {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        this->out += (char)(this->format == CBOR ? 0xfb : 0xcb);
+        this->bigEndian(bits, 8);
+    }
+    this->endValue();
+}
+
+void BinaryWriter::head(unsigned char major, unsigned long long value) {
+    unsigned char initial = major << 5;
+    if (value < 24) {
+        this->out += (char)(initial | value);
+    } else if (value <= 0xff) {
+        this->out += (char)(initial | 24);
+        this->bigEndian(value, 1);
+    } else if (value <= 0xffff) {
+        this->out += (char)(initial | 25);
+        this->bigEndian(value, 2);
+    } else if (value <= 0xffffffff) {
+        this->out += (char)(initial | 26);
+        this->bigEndian(value, 4);
+    } else {
+        this->out += (char)(initial | 27);
+        this->bigEndian(value, 8);
+    }
+}
+
+void BinaryWriter::bigEndian(unsigned long long value, int bytes) {
+    char buffer[8];
+    for (int i = 0; i < bytes; i += 1) {
+        buffer[i] = (char)(value >> (8 * (bytes - 1 - i)));
+    }
+    this->out.append(buffer, bytes);
+}
+
+void BinaryWriter::endValue() {
+    if (this->sink != nullptr and this->out.size() >= kFlushSize) {
+        this->flush();
+    }
+}
+
+// Reads CBOR or MessagePack items one at a time, for both ParseBinaryEvents and ParseBinary
+class BinaryDecoder {
+public:
+    BinaryDecoder(const char *&data, const char *end, BinaryFormat format)
+        : data(data), start(data), end(end), format(format), depth(0), failed(false) {
+    }
+
+    bool emit(JSONHandler &handler);
+
+    bool build(JSON &value);
+
+private:
+    struct Item {
+        enum Kind { NULL_ITEM, BOOLEAN, INTEGER, UNSIGNED, REAL, STRING, ARRAY, OBJECT } kind;
+        union {
+            bool boolean;
+            long long integer;
+            unsigned long long unsignedInteger;
+            double real;
+        };
+        // characters of a string, in the input or in buffer
+        const char *text;
+        // characters of a string, entries of a container
+        size_t size;
+        // CBOR container ended by a break instead of sized up front
+        bool indefinite;
+    };
+
+    const char *&data;
+    const char *start;
+    const char *end;
+    BinaryFormat format;
+    int depth;
+    bool failed;
+    // strings sent in chunks are joined here
+    std::string buffer;
+    // integer keys are written here as text
+    char number[kMaxNumberLength];
+
+    bool next(Item &item);
+    bool nextCBOR(Item &item);
+    bool nextMessagePack(Item &item);
+
+    // true while the container has entries left, index being the number already read
+    bool more(const Item &container, size_t index);
+    bool readKey(std::string_view &key);
+    bool enter();
+
+    bool readBigEndian(int bytes, unsigned long long &value);
+    bool readText(unsigned long long size, Item &item);
+    bool readChunks(unsigned char major, Item &item);
+    bool checkSize(Item &item, size_t bytesPerEntry);
+    void setUnsigned(unsigned long long value, Item &item);
+
+    bool fail(const char *message);
+};
+
+bool BinaryDecoder::emit(JSONHandler &handler) {
+    Item item;
+    if (not this->next(item)) {
+        return false;
+    }
+
+    switch (item.kind) {
+        case Item::NULL_ITEM:
+            return handler.null();
+        case Item::BOOLEAN:
+            return handler.boolean(item.boolean);
+        case Item::INTEGER:
+            return handler.integer(item.integer);
+        case Item::UNSIGNED:
+            return handler.unsignedInteger(item.unsignedInteger);
+        case Item::REAL:
+            return handler.real(item.real);
+        case Item::STRING:
+            return handler.string(item.text, item.size);
+        case Item::ARRAY:
+            if (not this->enter() or not handler.startArray()) {
+                return false;
+            }
+            for (size_t i = 0; this->more(item, i); i += 1) {
+                if (not this->emit(handler)) {
+                    return false;
+                }
+            }
+            this->depth -= 1;
+            return not this->failed and handler.endArray();
+        default: {
+            if (not this->enter() or not handler.startObject()) {
+                return false;
+            }
+            std::string_view key;
+            for (size_t i = 0; this->more(item, i); i += 1) {
+                if (not this->readKey(key) or not handler.key(key.data(), key.size()) or not this->emit(handler)) {
+                    return false;
+                }
+            }
+            this->depth -= 1;
+            return not this->failed and handler.endObject();
+        }
+    }
+}
+
+bool BinaryDecoder::build(JSON &value) {
+    Item item;
+    if (not this->next(item)) {
+        return false;
+    }
+
+    switch (item.kind) {
+        case Item::NULL_ITEM:
+            value = JSON(nullptr);
+            return true;
+        case Item::BOOLEAN:
+            value = JSON(item.boolean);
+            return true;
+        case Item::INTEGER:
+            value = JSON(item.integer);
+            return true;
+        case Item::UNSIGNED:
+            value = JSON(item.unsignedInteger);
+            return true;
+        case Item::REAL:
+            value = JSON(item.real);
+            return true;
+        case Item::STRING:
+            value = JSON(item.text, item.size);
+            return true;
+        case Item::ARRAY: {
+            if (not this->enter()) {
+                return false;
+            }
+            value = JSON(JSONType::VECTOR);
+            JSON::Vector &vector = *value.vector;
+            if (not item.indefinite) {
+                vector.reserve(item.size);
+            }
+            for (size_t i = 0; this->more(item, i); i += 1) {
+                vector.emplace_back();
+                if (not this->build(vector.back())) {
+                    return false;
+                }
+            }
+            this->depth -= 1;
+            return not this->failed;
+        }
+        default: {
+            if (not this->enter()) {
+                return false;
+            }
+            value = JSON(JSONType::OBJECT);
+            JSON::Object &object = *value.object;
+            if (not item.indefinite) {
+                object.reserve(item.size);
+            }
+            std::string_view key;
+            bool ok = true;
+            for (size_t i = 0; ok and this->more(item, i); i += 1) {
+                // nothing else is appended to this object while the value is read
+                ok = this->readKey(key) and this->build(object.append(key));
+            }
+            object.finish();
+            this->depth -= 1;
+            return ok and not this->failed;
+        }
+    }
+}
+
+bool BinaryDecoder::next(Item &item) {
+    return this->format == CBOR ? this->nextCBOR(item) : this->nextMessagePack(item);
+}
+
+bool BinaryDecoder::nextCBOR(Item &item) {
+    // tags only annotate the item after them, so they are skipped
+    while (true) {
+        if (this->data >= this->end) {
+            return this->fail("Unexpected end of input");
+        }
+
+        unsigned char initial = *this->data++;
+        unsigned char major = initial >> 5;
+        unsigned char info = initial & 0x1f;
+        unsigned long long argument = 0;
+        item.indefinite = false;
+
+        if (major == 7) {
+            switch (info) {
+                case 20:
+                case 21:
+                    item.kind = Item::BOOLEAN;
+                    item.boolean = info == 21;
+                    return true;
+                case 22:
+                case 23:
+                    // undefined has no JSON counterpart
+                    item.kind = Item::NULL_ITEM;
+                    return true;
+                case 25:
+                    if (not this->readBigEndian(2, argument)) {
+                        return false;
+                    }
+                    item.kind = Item::REAL;
+                    item.real = HalfToDouble(argument);
+                    return true;
+                case 26: {
+                    if (not this->readBigEndian(4, argument)) {
+                        return false;
+                    }
+                    uint32_t bits = argument;
+                    float single;
+                    memcpy(&single, &bits, sizeof(single));
+                    item.kind = Item::REAL;
+                    item.real = single;
+                    return true;
+                }
+                case 27: {
+                    if (not this->readBigEndian(8, argument)) {
+                        return false;
+                    }
+                    uint64_t bits = argument;
+                    item.kind = Item::REAL;
+                    memcpy(&item.real, &bits, sizeof(item.real));
+                    return true;
+                }
+                case 31:
+                    this->data--;
+                    return this->fail("Unexpected break");
+                default:
+                    this->data--;
+                    return this->fail("Unsupported simple value");
+            }
+        }
+
+        if (info < 24) {
+            argument = info;
+        } else if (info < 28) {
+            if (not this->readBigEndian(1 << (info - 24), argument)) {
+                return false;
+            }
+        } else if (info == 31 and major >= 2 and major <= 5) {
+            item.indefinite = true;
+        } else {
+            this->data--;
+            return this->fail("Invalid length");
+        }
+
+        switch (major) {
+            case 0:
+                this->setUnsigned(argument, item);
+                return true;
+            case 1:
+                if (argument <= LLONG_MAX) {
+                    item.kind = Item::INTEGER;
+                    item.integer = -1 - (long long)argument;
+                } else {
+                    // below the range of long long, like big numbers in text
+                    item.kind = Item::REAL;
+                    item.real = -1.0 - (double)argument;
+                }
+                return true;
+            case 2:
+            case 3:
+                return item.indefinite ? this->readChunks(major, item) : this->readText(argument, item);
+            case 4:
+                item.kind = Item::ARRAY;
+                item.size = argument;
+                return this->checkSize(item, 1);
+            case 5:
+                item.kind = Item::OBJECT;
+                item.size = argument;
+                return this->checkSize(item, 2);
+            default:
+                continue;
+        }
+    }
+}
+
+bool BinaryDecoder::nextMessagePack(Item &item) {
+    if (this->data >= this->end) {
+        return this->fail("Unexpected end of input");
+    }
+
+    unsigned char initial = *this->data++;
+    unsigned long long argument = 0;
+    item.indefinite = false;
+
+    if (initial < 0x80) {
+        this->setUnsigned(initial, item);
+        return true;
+    }
+    if (initial >= 0xe0) {
+        item.kind = Item::INTEGER;
+        item.integer = (signed char)initial;
+        return true;
+    }
+    if (initial < 0x90) {
+        item.kind = Item::OBJECT;
+        item.size = initial & 0x0f;
+        return this->checkSize(item, 2);
+    }
+    if (initial < 0xa0) {
+        item.kind = Item::ARRAY;
+        item.size = initial & 0x0f;
+        return this->checkSize(item, 1);
+    }
+    if (initial < 0xc0) {
+        return this->readText(initial & 0x1f, item);
+    }
+
+    switch (initial) {
+        case 0xc0:
+            item.kind = Item::NULL_ITEM;
+            return true;
+        case 0xc2:
+        case 0xc3:
+            item.kind = Item::BOOLEAN;
+            item.boolean = initial == 0xc3;
+            return true;
+        // bin 8/16/32 are read as strings, like str 8/16/32
+        case 0xc4:
+        case 0xd9:
+            return this->readBigEndian(1, argument) and this->readText(argument, item);
+        case 0xc5:
+        case 0xda:
+            return this->readBigEndian(2, argument) and this->readText(argument, item);
+        case 0xc6:
+        case 0xdb:
+            return this->readBigEndian(4, argument) and this->readText(argument, item);
+        case 0xca: {
+            if (not this->readBigEndian(4, argument)) {
+                return false;
+            }
+            uint32_t bits = argument;
+            float single;
+            memcpy(&single, &bits, sizeof(single));
+            item.kind = Item::REAL;
+            item.real = single;
+            return true;
+        }
+        case 0xcb: {
+            if (not this->readBigEndian(8, argument)) {
+                return false;
+            }
+            uint64_t bits = argument;
+            item.kind = Item::REAL;
+            memcpy(&item.real, &bits, sizeof(item.real));
+            return true;
+        }
+        case 0xcc:
+        case 0xcd:
+        case 0xce:
+        case 0xcf:
+            if (not this->readBigEndian(1 << (initial - 0xcc), argument)) {
+                return false;
+            }
+            this->setUnsigned(argument, item);
+            return true;
+        case 0xd0:
+        case 0xd1:
+        case 0xd2:
+        case 0xd3: {
+            int bytes = 1 << (initial - 0xd0);
+            if (not this->readBigEndian(bytes, argument)) {
+                return false;
+            }
+            item.kind = Item::INTEGER;
+            if (bytes == 1) {
+                item.integer = (int8_t)argument;
+            } else if (bytes == 2) {
+                item.integer = (int16_t)argument;
+            } else if (bytes == 4) {
+                item.integer = (int32_t)argument;
+            } else {
+                item.integer = (long long)argument;
+            }
+            return true;
+        }
+        case 0xdc:
+        case 0xdd:
+            if (not this->readBigEndian(initial == 0xdc ? 2 : 4, argument)) {
+                return false;
+            }
+            item.kind = Item::ARRAY;
+            item.size = argument;
+            return this->checkSize(item, 1);
+        case 0xde:
+        case 0xdf:
+            if (not this->readBigEndian(initial == 0xde ? 2 : 4, argument)) {
+                return false;
+            }
+            item.kind = Item::OBJECT;
+            item.size = argument;
+            return this->checkSize(item, 2);
+        default:
+            this->data--;
+            return this->fail("Unsupported MessagePack type");
+    }
+}
+
+bool BinaryDecoder::more(const Item &container, size_t index) {
+    if (this->failed) {
+        return false;
+    }
+    if (not container.indefinite) {
+        return index < container.size;
+    }
+
+    if (this->data >= this->end) {
+        return this->fail("Unexpected end of input");
+    }
+    if ((unsigned char)*this->data == 0xff) {
+        this->data++;
+        return false;
+    }
+    return true;
+}
+
+bool BinaryDecoder::readKey(std::string_view &key) {
+    Item item;
+    if (not this->next(item)) {
+        return false;
+    }
+
+    if (item.kind == Item::STRING) {
+        key = std::string_view(item.text, item.size);
+    } else if (item.kind == Item::INTEGER) {
+        key = std::string_view(this->number, FormatInteger(item.integer, this->number));
+    } else if (item.kind == Item::UNSIGNED) {
+        key = std::string_view(this->number, FormatUnsigned(item.unsignedInteger, this->number));
+    } else {
+        return this->fail("Expected a string or an integer as key");
+    }
+    return true;
+}
+
+bool BinaryDecoder::enter() {
+    this->depth += 1;
+    if (this->depth > kMaxBinaryDepth) {
+        return this->fail("Nested too deep");
+    }
+    return true;
+}
+
+bool BinaryDecoder::readBigEndian(int bytes, unsigned long long &value) {
+    if (this->end - this->data < bytes) {
+        return this->fail("Unexpected end of input");
+    }
+
+    value = 0;
+    for (int i = 0; i < bytes; i += 1) {
+        value = (value << 8) | (unsigned char)this->data[i];
+    }
+    this->data += bytes;
+    return true;
+}
+
+bool BinaryDecoder::readText(unsigned long long size, Item &item) {
+    if (size > (unsigned long long)(this->end - this->data)) {
+        return this->fail("Unexpected end of input");
+    }
+
+    item.kind = Item::STRING;
+    item.text = this->data;
+    item.size = size;
+    this->data += size;
+    return true;
+}
+
+bool BinaryDecoder::readChunks(unsigned char major, Item &item) {
+    this->buffer.clear();
+    while (true) {
+        if (this->data >= this->end) {
+            return this->fail("Unexpected end of input");
+        }
+        if ((unsigned char)*this->data == 0xff) {
+            this->data++;
+            break;
+        }
+
+        // every chunk is a sized string of the same kind
+        unsigned char initial = *this->data++;
+        unsigned char info = initial & 0x1f;
+        unsigned long long size = info;
+        if ((initial >> 5) != major or info >= 28) {
+            this->data--;
+            return this->fail("Invalid string chunk");
+        }
+        if (info >= 24 and not this->readBigEndian(1 << (info - 24), size)) {
+            return false;
+        }
+
+        Item chunk{};
+        if (not this->readText(size, chunk)) {
+            return false;
+        }
+        this->buffer.append(chunk.text, chunk.size);
+    }
+
+    item.kind = Item::STRING;
+    item.text = this->buffer.data();
+    item.size = this->buffer.size();
+    return true;
+}
+
+bool BinaryDecoder::checkSize(Item &item, size_t bytesPerEntry) {
+    // every entry takes at least a byte per item, so larger sizes cannot be right
+    if (not item.indefinite and item.size > (size_t)(this->end - this->data) / bytesPerEntry) {
+        return this->fail("Unexpected end of input");
+    }
+    return true;
+}
+
+void BinaryDecoder::setUnsigned(unsigned long long value, Item &item) {
+    if (value <= LLONG_MAX) {
+        item.kind = Item::INTEGER;
+        item.integer = value;
+    } else {
+        item.kind = Item::UNSIGNED;
+        item.unsignedInteger = value;
+    }
+}
+
+bool BinaryDecoder::fail(const char *message) {
+    if (not this->failed) {
+        std::cerr << "[ERROR]\t" << message << " at byte " << (this->data - this->start) << '\n';
+    }
+    this->failed = true;
+    return false;
+}
+
+bool ParseBinaryEvents(const char *&data, const char *end, BinaryFormat format, JSONHandler &handler) {
+    BinaryDecoder decoder(data, end, format);
+    return decoder.emit(handler);
+}
+
+JSON ParseBinary(const char *&data, const char *end, BinaryFormat format) {
+    BinaryDecoder decoder(data, end, format);
+    JSON value;
+    if (not decoder.build(value)) {
+        return JSON();
+    }
+    return value;
+}
+
+}  // namespace autojson
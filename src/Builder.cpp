@@ -0,0 +1,487 @@
+#include "Builder.hpp"
+
+#include <cstring>
+#include <limits>
+#include <new>
+
+#include "Instrument.hpp"
+#include "Parse.hpp"
+
+namespace autojson {
+
+namespace {
+
+// Containers nested deeper than this are an error for tryParse, instead of recursing further
+const size_t kMaxParseDepth = 1024;
+
+// What tryParse takes as a bare word: null, true, false or a JSON number, which ParsePrimitive
+// also reads but with a leading + or leading zeros as well
+bool IsJSONWord(const char *word, size_t size, const JSON &value) {
+    if (value.primitiveType() == JSONPrimitiveType::RAW or word[0] == '+') {
+        return false;
+    }
+    size_t digits = word[0] == '-' ? 1 : 0;
+    return not (size > digits + 1 and word[digits] == '0' and word[digits + 1] >= '0' and word[digits + 1] <= '9');
+}
+
+}  // namespace
+
+JSON JSONBuilder::parse(const char *&content) {
+    SkipWhitespace(content, ",");
+
+    if (*content == '\0') {
+        ParseError("Unexpected EOF", content);
+        return JSON();
+    }
+
+    JSON result;
+    if (*content == '{') {
+        result = this->parseObject(content);
+    } else if (*content == '[') {
+        result = this->parseVector(content);
+    } else if (*content == '\"' or *content == '\'') {
+        ParseString(content, this->buffer);
+        result = this->makeString(this->buffer.data(), this->buffer.size());
+    } else {
+        const char *start = content;
+        SkipWord(content);
+        result = this->makePrimitive(start, content - start);
+    }
+
+    SkipWhitespace(content, ",");
+    return result;
+}
+
+JSON JSONBuilder::parseVector(const char *&content) {
+    size_t first = this->stack.size();
+
+    content++; // skip [
+
+    while (1) {
+        SkipWhitespace(content, ",");
+        if (*content == ']') {
+            content++;
+            break;
+        }
+        if (*content == '\0') {
+            ParseError("Unexpected EOF", content);
+            break;
+        }
+
+        // a } or : where a value should be is read as nothing, and would be again and again
+        const char *start = content;
+        JSON value = this->parse(content);
+        if (content == start) {
+            ParseError("Unexpected character", content);
+            break;
+        }
+        this->stack.emplace_back(std::move(value));
+    }
+
+    return this->makeVector(first);
+}
+
+JSON JSONBuilder::parseObject(const char *&content) {
+    size_t first = this->stack.size();
+    size_t firstKey = this->keys.size();
+
+    content++; // skip {
+
+    while (1) {
+        SkipWhitespace(content, ",");
+        if (*content == '}') {
+            content++;
+            break;
+        }
+        if (*content == '\0') {
+            ParseError("Unexpected EOF", content);
+            break;
+        }
+
+        ParseString(content, this->buffer);
+        this->pushKey(this->buffer.data(), this->buffer.size());
+        SkipWhitespace(content, ""); // get to :
+        if (*content != ':') {
+            ParseError("Expected ':'. Got something else", content);
+            if (*content == '\0') {
+                // the key keeps a null value, so keys and values still pair up
+                this->stack.emplace_back();
+                break;
+            }
+        }
+
+        content++;
+        SkipWhitespace(content, ",");
+        const char *start = content;
+        this->stack.emplace_back(this->parse(content));
+        if (content == start) {
+            ParseError("Unexpected character", content);
+            break;
+        }
+    }
+
+    return this->makeObject(first, firstKey);
+}
+
+JSON JSONBuilder::parseIndexed(const char *content, size_t size, StructuralKernel kernel) {
+    if (size >= std::numeric_limits<uint32_t>::max()) {
+        // offsets are 32 bits wide
+        const char *content_p = content;
+        return this->parse(content_p);
+    }
+
+    this->input = content;
+    this->inputSize = size;
+    this->index.clear();
+    BuildStructuralIndex(content, size, this->index, kernel);
+    this->index.push_back((uint32_t)size);
+    this->position = 0;
+    this->tokenEnd = 0;
+
+    if (this->strict and not this->checkSeparator(false)) {
+        return JSON();
+    }
+    return this->parseIndexedValue();
+}
+
+JSON JSONBuilder::tryParse(const char *content, size_t size, ParseResult &result, StructuralKernel kernel) {
+    this->strict = true;
+    JSON value = this->parseBounded(content, size, result, kernel);
+    this->strict = false;
+    return value;
+}
+
+JSON JSONBuilder::parseBounded(const char *content, size_t size, ParseResult &result, StructuralKernel kernel) {
+    result = ParseResult();
+    if (size >= std::numeric_limits<uint32_t>::max()) {
+        result.status = PARSE_TOO_LARGE;
+        return JSON();
+    }
+
+    this->result = &result;
+    this->depth = 0;
+    this->maxDepth = kMaxParseDepth;
+
+    JSON value = this->parseIndexed(content, size, kernel);
+    // a NUL byte is not the end here
+    if (this->index[this->position] != size) {
+        this->fail(PARSE_TRAILING_CHARACTERS, "Unexpected character after the end of the document",
+                   this->index[this->position]);
+    } else if (this->strict) {
+        this->checkSeparator(false);
+    }
+
+    this->result = nullptr;
+    this->maxDepth = SIZE_MAX;
+    if (not result.ok()) {
+        return JSON();
+    }
+    return value;
+}
+
+JSON JSONBuilder::parseIndexedValue() {
+    uint32_t offset = this->index[this->position];
+    switch (this->peekIndexed()) {
+        case '\0':
+            this->fail(PARSE_UNEXPECTED_EOF, "Unexpected EOF", offset);
+            return JSON();
+        case '{':
+            this->tokenEnd = offset + 1;
+            return this->parseIndexedObject();
+        case '[':
+            this->tokenEnd = offset + 1;
+            return this->parseIndexedVector();
+        case '\"':
+        case '\'': {
+            const char *data;
+            size_t size;
+            if (not this->readIndexedString(data, size)) {
+                return JSON();
+            }
+            return this->makeString(data, size);
+        }
+        case '}':
+        case ']':
+        case ':':
+            this->position++;
+            this->fail(PARSE_UNEXPECTED_CHARACTER, "Unexpected character", offset);
+            return JSON();
+        default:
+            break;
+    }
+
+    // a bare word runs until the next whitespace or the next indexed character
+    const char *start = this->input + offset;
+    const char *limit = this->input + this->index[this->position + 1];
+    const char *end = start;
+    while (end != limit and *end != ' ' and *end != '\t' and *end != '\n' and *end != '\r' and *end != ',') {
+        end++;
+    }
+    this->position++;
+    this->tokenEnd = end - this->input;
+
+    JSON value = this->makePrimitive(start, end - start);
+    if (this->strict and not IsJSONWord(start, end - start, value)) {
+        this->fail(PARSE_UNEXPECTED_CHARACTER, "Not a number, true, false or null", offset);
+        return JSON();
+    }
+    return value;
+}
+
+JSON JSONBuilder::parseIndexedVector() {
+    if (this->depth == this->maxDepth) {
+        this->fail(PARSE_TOO_DEEP, "Nested too deep", this->index[this->position]);
+        return JSON();
+    }
+    this->depth += 1;
+
+    size_t first = this->stack.size();
+
+    this->position++; // skip [
+
+    while (1) {
+        char c = this->peekIndexed();
+        if (this->strict and c != '\0' and
+            not this->checkSeparator(c != ']' and this->stack.size() > first)) {
+            break;
+        }
+        if (c == ']') {
+            this->tokenEnd = this->index[this->position] + 1;
+            this->position++;
+            break;
+        }
+        if (c == '\0') {
+            this->fail(PARSE_UNEXPECTED_EOF, "Unexpected EOF", this->index[this->position]);
+            break;
+        }
+
+        this->stack.emplace_back(this->parseIndexedValue());
+    }
+
+    this->depth -= 1;
+    return this->makeVector(first);
+}
+
+JSON JSONBuilder::parseIndexedObject() {
+    if (this->depth == this->maxDepth) {
+        this->fail(PARSE_TOO_DEEP, "Nested too deep", this->index[this->position]);
+        return JSON();
+    }
+    this->depth += 1;
+
+    size_t first = this->stack.size();
+    size_t firstKey = this->keys.size();
+
+    this->position++; // skip {
+
+    while (1) {
+        char c = this->peekIndexed();
+        if (this->strict and c != '\0' and
+            not this->checkSeparator(c != '}' and this->keys.size() > firstKey)) {
+            break;
+        }
+        if (c == '}') {
+            this->tokenEnd = this->index[this->position] + 1;
+            this->position++;
+            break;
+        }
+        if (c == '\0') {
+            this->fail(PARSE_UNEXPECTED_EOF, "Unexpected EOF", this->index[this->position]);
+            break;
+        }
+        if (c != '\"' and c != '\'') {
+            this->fail(PARSE_EXPECTED_KEY, "Expected a key. Got something else", this->index[this->position]);
+            break;
+        }
+
+        const char *key;
+        size_t keySize;
+        if (not this->readIndexedString(key, keySize)) {
+            break;
+        }
+        this->pushKey(key, keySize);
+
+        if (this->peekIndexed() != ':') {
+            this->fail(PARSE_EXPECTED_COLON, "Expected ':'. Got something else", this->index[this->position]);
+            this->stack.emplace_back();
+            break;
+        }
+        if (this->strict and not this->checkSeparator(false)) {
+            this->stack.emplace_back();
+            break;
+        }
+
+        this->tokenEnd = this->index[this->position] + 1;
+        this->position++;
+        if (this->strict and this->peekIndexed() != '\0' and not this->checkSeparator(false)) {
+            this->stack.emplace_back();
+            break;
+        }
+        this->stack.emplace_back(this->parseIndexedValue());
+    }
+
+    this->depth -= 1;
+    return this->makeObject(first, firstKey);
+}
+
+bool JSONBuilder::readIndexedString(const char *&data, size_t &size) {
+    // everything inside a string is masked out of the index, so the next offset is the closing quote
+    uint32_t open = this->index[this->position];
+    uint32_t close = this->index[this->position + 1];
+    if (close >= this->inputSize) {
+        this->position++;
+        this->fail(PARSE_UNEXPECTED_EOF, "Unexpected EOF in string", open);
+        return false;
+    }
+    this->position += 2;
+    this->tokenEnd = close + 1;
+
+    if (this->strict and (this->input[open] != '\"' or this->input[close] != '\"')) {
+        this->fail(PARSE_UNEXPECTED_CHARACTER, "Strings must be in double quotes",
+                   this->input[open] != '\"' ? open : close);
+        return false;
+    }
+
+    data = this->input + open + 1;
+    size = close - open - 1;
+    if (memchr(data, '\\', size) != nullptr) {
+        UnescapeString(data, data + size, this->buffer);
+        data = this->buffer.data();
+        size = this->buffer.size();
+    }
+    return true;
+}
+
+JSON JSONBuilder::makeString(const char *data, size_t size) {
+    if (this->arena == nullptr or size <= JSON::kInlineTextCapacity) {
+        return JSON(data, size);
+    }
+
+    JSON j;
+    j.type = JSONType::STRING;
+    j.text.data = (char*)this->arena->allocate(size, 1);
+    j.text.size = size;
+    j.flags = JSON::ARENA;
+    memcpy(j.text.data, data, size);
+    return j;
+}
+
+JSON JSONBuilder::makePrimitive(const char *word, size_t size) {
+    JSON j = ParsePrimitive(word, size);
+    this->moveToArena(j);
+    return j;
+}
+
+JSON JSONBuilder::makeVector(size_t first) {
+    JSON j;
+    if (this->arena != nullptr) {
+        void *memory = this->arena->allocate(sizeof(JSON::Vector), alignof(JSON::Vector));
+        j.vector = new (memory) JSON::Vector(ArenaAllocator<JSON>(this->arena));
+        j.flags = JSON::ARENA;
+    } else {
+        AUTOJSON_COUNT(NODES_ALLOCATED, 1);
+        j.vector = new JSON::Vector;
+    }
+    j.type = JSONType::VECTOR;
+
+    auto& v = *j.vector;
+    v.reserve(this->stack.size() - first);
+    for (size_t i = first; i < this->stack.size(); i += 1) {
+        v.emplace_back(std::move(this->stack[i]));
+    }
+    this->stack.resize(first);
+
+    return j;
+}
+
+JSON JSONBuilder::makeObject(size_t first, size_t firstKey) {
+    JSON j;
+    if (this->arena != nullptr) {
+        void *memory = this->arena->allocate(sizeof(JSON::Object), alignof(JSON::Object));
+        j.object = new (memory) JSON::Object(GetDefaultKeyOrder(), JSON::Object::allocator_type(this->arena));
+        j.flags = JSON::ARENA;
+    } else {
+        AUTOJSON_COUNT(NODES_ALLOCATED, 1);
+        j.object = new JSON::Object;
+    }
+    j.type = JSONType::OBJECT;
+
+    auto& m = *j.object;
+    m.reserve(this->keys.size() - firstKey);
+    // tryParse() and parseBounded() are for untrusted input: their keys reuse the key table
+    // but never add to it
+    const bool internNewKeys = this->result == nullptr;
+    for (size_t i = firstKey; i < this->keys.size(); i += 1) {
+        const auto& key = this->keys[i];
+        m.append(std::string_view(this->keyText.data() + key.first, key.second), internNewKeys) = std::move(this->stack[first + i - firstKey]);
+    }
+    m.finish();
+
+    if (firstKey < this->keys.size()) {
+        this->keyText.resize(this->keys[firstKey].first);
+    }
+    this->keys.resize(firstKey);
+    this->stack.resize(first);
+
+    return j;
+}
+
+void JSONBuilder::pushKey(const char *key, size_t size) {
+    this->keys.emplace_back(this->keyText.size(), size);
+    this->keyText.append(key, size);
+}
+
+void JSONBuilder::clear() {
+    this->stack.clear();
+    this->keys.clear();
+    this->keyText.clear();
+}
+
+void JSONBuilder::fail(JSONParseStatus status, const char *message, size_t offset) {
+    if (this->result == nullptr) {
+        ParseError(message, offset < this->inputSize ? this->input + offset : "");
+        return;
+    }
+
+    if (this->result->ok()) {
+        this->result->status = status;
+        this->result->offset = offset;
+    }
+    this->position = this->index.size() - 1;
+}
+
+bool JSONBuilder::checkSeparator(bool comma) {
+    size_t next = this->index[this->position];
+    bool seen = false;
+    for (size_t i = this->tokenEnd; i < next; i += 1) {
+        char c = this->input[i];
+        if (c == ',' and comma and not seen) {
+            seen = true;
+        } else if (c != ' ' and c != '\t' and c != '\n' and c != '\r') {
+            this->fail(PARSE_UNEXPECTED_CHARACTER, "Unexpected character between values", i);
+            return false;
+        }
+    }
+    if (comma and not seen) {
+        this->fail(PARSE_UNEXPECTED_CHARACTER, "Expected ','", next);
+        return false;
+    }
+    return true;
+}
+
+void JSONBuilder::moveToArena(JSON &node) {
+    // only RAW text too long to be stored inline owns heap memory at this point
+    if (this->arena == nullptr or (node.flags & JSON::INLINE_TEXT) or
+        not (node.type == JSONType::STRING or (node.type == JSONType::PRIMITIVE and node.primitive == JSONPrimitiveType::RAW))) {
+        return;
+    }
+
+    char *data = (char*)this->arena->allocate(node.text.size, 1);
+    memcpy(data, node.text.data, node.text.size);
+    AUTOJSON_COUNT(NODES_FREED, 1);
+    delete[] node.text.data;
+    node.text.data = data;
+    node.flags |= JSON::ARENA;
+}
+
+}  // namespace autojson
@@ -0,0 +1,135 @@
+#ifndef AUTOJSON_BUILDER_HPP
+#define AUTOJSON_BUILDER_HPP
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Arena.hpp"
+#include "JSON.hpp"
+#include "StructuralIndex.hpp"
+
+namespace autojson {
+
+// Builds the tree for JSON::parse and JSONDocument::parse.
+// Without an arena the result is a regular heap tree. With one, every payload is carved
+// out of the arena, the nodes are flagged so nothing tries to free them, and arrays get
+// exactly the size they need because their elements are collected on a stack first.
+// Objects too: their entries are sorted and deduplicated once, when they are complete.
+class JSONBuilder {
+public:
+    explicit JSONBuilder(Arena *arena = nullptr) : arena(arena) { }
+
+    JSON parse(const char *&content);
+
+    JSON parseVector(const char *&content);
+
+    JSON parseObject(const char *&content);
+
+    // Same grammar as parse(), but walks the offsets found by BuildStructuralIndex
+    // instead of looking at every byte. content does not need to be NUL terminated.
+    JSON parseIndexed(const char *content, size_t size, StructuralKernel kernel = AUTO_KERNEL);
+
+    // Same as parseIndexed(), but the first error is written to result instead of being
+    // printed, and ends the parse. The tree is invalid then. The grammar is stricter too,
+    // see JSON::tryParse.
+    JSON tryParse(const char *content, size_t size, ParseResult &result, StructuralKernel kernel = AUTO_KERNEL);
+
+    // Same grammar as parseIndexed(), within the limits of tryParse(): the first error is
+    // written to result and ends the parse, and containers nest at most 1024 deep. For input
+    // that cannot be trusted but is read with the lenient grammar, like JSONReader does.
+    JSON parseBounded(const char *content, size_t size, ParseResult &result, StructuralKernel kernel = AUTO_KERNEL);
+
+    JSON makeString(const char *data, size_t size);
+
+    JSON makePrimitive(const char *word, size_t size);
+
+    // Turns stack[first..] into an array and pops those elements
+    JSON makeVector(size_t first);
+
+    // Turns keys[firstKey..] and stack[first..] into an object and pops them
+    JSON makeObject(size_t first, size_t firstKey);
+
+    // For parsers that find the values themselves: values and keys are pushed as they are
+    // read, and a container is made of what was pushed since it started
+    void push(JSON value) {
+        this->stack.emplace_back(std::move(value));
+    }
+
+    void pushKey(const char *key, size_t size);
+
+    // Takes the last value pushed
+    JSON pop() {
+        JSON value = std::move(this->stack.back());
+        this->stack.pop_back();
+        return value;
+    }
+
+    size_t stackSize() const {
+        return this->stack.size();
+    }
+
+    size_t keyCount() const {
+        return this->keys.size();
+    }
+
+    // Drops everything pushed, keeping the memory
+    void clear();
+
+private:
+    Arena *arena;
+
+    std::vector<JSON> stack;
+    std::string buffer;
+
+    // keys of the objects being built, as (offset, size) in keyText
+    std::vector<std::pair<size_t, size_t>> keys;
+    std::string keyText;
+
+    // state of parseIndexed; index ends with the offset of the end of the input
+    const char *input = nullptr;
+    size_t inputSize = 0;
+    std::vector<uint32_t> index;
+    size_t position = 0;
+    // offset right after the last token read, where the separators before the next one start
+    size_t tokenEnd = 0;
+    // where tryParse and parseBounded want the error, nullptr when errors are printed
+    ParseResult *result = nullptr;
+    // tryParse only: the stricter grammar of JSON::tryParse
+    bool strict = false;
+    // containers open, and how many may be; only tryParse and parseBounded limit them
+    size_t depth = 0;
+    size_t maxDepth = SIZE_MAX;
+
+    JSON parseIndexedValue();
+    JSON parseIndexedVector();
+    JSON parseIndexedObject();
+
+    // Reads the string opening at index[position] into [data, data + size)
+    bool readIndexedString(const char *&data, size_t &size);
+
+    // tryParse only: what is between tokenEnd and index[position] must be whitespace, with
+    // exactly one comma when comma is set. Fails otherwise.
+    bool checkSeparator(bool comma);
+
+    // Reports an error of the indexed parser. For tryParse, keeps the first one and moves to
+    // the end of the index, so every open container ends right away.
+    void fail(JSONParseStatus status, const char *message, size_t offset);
+
+    // Character at index[position], or '\0' at the end of the input
+    char peekIndexed() const {
+        uint32_t offset = this->index[this->position];
+        return offset < this->inputSize ? this->input[offset] : '\0';
+    }
+
+    void moveToArena(JSON &node);
+};
+
+}  // namespace autojson
+
+#ifndef autojsonuselib
+#include "autojson_src/Builder.cpp"
+#endif
+
+#endif // AUTOJSON_BUILDER_HPP
@@ -0,0 +1,62 @@
+#include "Document.hpp"
+
+#include "Builder.hpp"
+#include "Instrument.hpp"
+
+namespace autojson {
+
+JSONDocument::~JSONDocument() {
+    this->clear();
+}
+
+const JSON& JSONDocument::parse(const char *&content) {
+    AUTOJSON_TIME(PARSE_TIME);
+    this->clear();
+
+    const char *start = content;
+    JSONBuilder builder(&this->memory);
+    this->rootNode = builder.parse(content);
+    AUTOJSON_COUNT(BYTES_PARSED, content - start);
+    return this->rootNode;
+}
+
+const JSON& JSONDocument::parse(const std::string &content) {
+    const char *content_p = content.c_str();
+    return this->parse(content_p);
+}
+
+const JSON& JSONDocument::parseIndexed(const char *content, size_t size) {
+    AUTOJSON_TIME(PARSE_TIME);
+    AUTOJSON_COUNT(BYTES_PARSED, size);
+    this->clear();
+
+    JSONBuilder builder(&this->memory);
+    this->rootNode = builder.parseIndexed(content, size);
+    return this->rootNode;
+}
+
+const JSON& JSONDocument::parseIndexed(const std::string &content) {
+    return this->parseIndexed(content.data(), content.size());
+}
+
+const JSON& JSONDocument::tryParse(const char *content, size_t size, ParseResult &result) {
+    AUTOJSON_TIME(PARSE_TIME);
+    AUTOJSON_COUNT(BYTES_PARSED, size);
+    this->clear();
+
+    JSONBuilder builder(&this->memory);
+    this->rootNode = builder.tryParse(content, size, result);
+    return this->rootNode;
+}
+
+const JSON& JSONDocument::tryParse(const std::string &content, ParseResult &result) {
+    return this->tryParse(content.data(), content.size(), result);
+}
+
+void JSONDocument::clear() {
+    // the root is flagged as living in the arena, so this does not walk the tree
+    this->rootNode = JSON();
+    this->memory.release();
+}
+
+}  // namespace autojson
@@ -0,0 +1,423 @@
+#include "Format.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "JSON.hpp"
+#include "Parse.hpp"
+
+namespace autojson {
+
+namespace {
+
+const char kDigitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Writes the digits of value right to left, two at a time, ending just before end
+char* WriteDigitsBackwards(unsigned long long value, char *end) {
+    while (value >= 100) {
+        const char *pair = kDigitPairs + 2 * (value % 100);
+        value /= 100;
+        *--end = pair[1];
+        *--end = pair[0];
+    }
+    if (value >= 10) {
+        const char *pair = kDigitPairs + 2 * value;
+        *--end = pair[1];
+        *--end = pair[0];
+    } else {
+        *--end = (char)('0' + value);
+    }
+    return end;
+}
+
+/// Grisu2, after Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately
+/// with Integers". Always round-trips and is the shortest possible for the vast majority of values.
+
+// f * 2^e
+struct DiyFp {
+    uint64_t f;
+    int e;
+
+    DiyFp(uint64_t f, int e) : f(f), e(e) { }
+
+    DiyFp operator-(const DiyFp &rhs) const {
+        return DiyFp(this->f - rhs.f, this->e);
+    }
+
+    // rounded upper 64 bits of the 128 bit product
+    DiyFp operator*(const DiyFp &rhs) const {
+        unsigned __int128 product = (unsigned __int128)this->f * rhs.f;
+        uint64_t high = (uint64_t)(product >> 64);
+        uint64_t low = (uint64_t)product;
+        high += low >> 63;
+        return DiyFp(high, this->e + rhs.e + 64);
+    }
+
+    DiyFp normalized() const {
+        int shift = __builtin_clzll(this->f);
+        return DiyFp(this->f << shift, this->e - shift);
+    }
+
+    DiyFp normalizedTo(int e) const {
+        return DiyFp(this->f << (this->e - e), e);
+    }
+};
+
+// The value and the two halfway points to its neighbours, with the same exponent
+struct Boundaries {
+    DiyFp w;
+    DiyFp minus;
+    DiyFp plus;
+};
+
+template<typename Float>
+Boundaries ComputeBoundaries(Float value) {
+    // sizes of the IEEE 754 fields
+    const int kSignificandBits = std::numeric_limits<Float>::digits - 1;
+    const int kBias = std::numeric_limits<Float>::max_exponent - 1 + kSignificandBits;
+    const int kExponentBits = sizeof(Float) * 8 - 1 - kSignificandBits;
+    const uint64_t kHiddenBit = 1ULL << kSignificandBits;
+
+    uint64_t bits;
+    if (sizeof(Float) == 8) {
+        uint64_t raw;
+        memcpy(&raw, &value, sizeof(raw));
+        bits = raw;
+    } else {
+        uint32_t raw;
+        memcpy(&raw, &value, sizeof(raw));
+        bits = raw;
+    }
+
+    const uint64_t exponent = (bits >> kSignificandBits) & ((1ULL << kExponentBits) - 1);
+    const uint64_t fraction = bits & (kHiddenBit - 1);
+
+    DiyFp v = exponent == 0 ? DiyFp(fraction, 1 - kBias)
+                            : DiyFp(fraction + kHiddenBit, (int)exponent - kBias);
+
+    // the gap below a power of two is half the gap above it
+    const bool lowerIsCloser = (fraction == 0 and exponent > 1);
+    DiyFp plus(2 * v.f + 1, v.e - 1);
+    DiyFp minus = lowerIsCloser ? DiyFp(4 * v.f - 1, v.e - 2) : DiyFp(2 * v.f - 1, v.e - 1);
+
+    DiyFp plusNormalized = plus.normalized();
+    return Boundaries{v.normalized(), minus.normalizedTo(plusNormalized.e), plusNormalized};
+}
+
+struct CachedPower {
+    uint64_t f;
+    int e;
+    int k;
+};
+
+// 10^k ~= f * 2^e for k = -300, -292, ..., 324
+const CachedPower kCachedPowers[] = {
+    { 0xAB70FE17C79AC6CAULL, -1060, -300 },
+    { 0xFF77B1FCBEBCDC4FULL, -1034, -292 },
+    { 0xBE5691EF416BD60CULL, -1007, -284 },
+    { 0x8DD01FAD907FFC3CULL,  -980, -276 },
+    { 0xD3515C2831559A83ULL,  -954, -268 },
+    { 0x9D71AC8FADA6C9B5ULL,  -927, -260 },
+    { 0xEA9C227723EE8BCBULL,  -901, -252 },
+    { 0xAECC49914078536DULL,  -874, -244 },
+    { 0x823C12795DB6CE57ULL,  -847, -236 },
+    { 0xC21094364DFB5637ULL,  -821, -228 },
+    { 0x9096EA6F3848984FULL,  -794, -220 },
+    { 0xD77485CB25823AC7ULL,  -768, -212 },
+    { 0xA086CFCD97BF97F4ULL,  -741, -204 },
+    { 0xEF340A98172AACE5ULL,  -715, -196 },
+    { 0xB23867FB2A35B28EULL,  -688, -188 },
+    { 0x84C8D4DFD2C63F3BULL,  -661, -180 },
+    { 0xC5DD44271AD3CDBAULL,  -635, -172 },
+    { 0x936B9FCEBB25C996ULL,  -608, -164 },
+    { 0xDBAC6C247D62A584ULL,  -582, -156 },
+    { 0xA3AB66580D5FDAF6ULL,  -555, -148 },
+    { 0xF3E2F893DEC3F126ULL,  -529, -140 },
+    { 0xB5B5ADA8AAFF80B8ULL,  -502, -132 },
+    { 0x87625F056C7C4A8BULL,  -475, -124 },
+    { 0xC9BCFF6034C13053ULL,  -449, -116 },
+    { 0x964E858C91BA2655ULL,  -422, -108 },
+    { 0xDFF9772470297EBDULL,  -396, -100 },
+    { 0xA6DFBD9FB8E5B88FULL,  -369,  -92 },
+    { 0xF8A95FCF88747D94ULL,  -343,  -84 },
+    { 0xB94470938FA89BCFULL,  -316,  -76 },
+    { 0x8A08F0F8BF0F156BULL,  -289,  -68 },
+    { 0xCDB02555653131B6ULL,  -263,  -60 },
+    { 0x993FE2C6D07B7FACULL,  -236,  -52 },
+    { 0xE45C10C42A2B3B06ULL,  -210,  -44 },
+    { 0xAA242499697392D3ULL,  -183,  -36 },
+    { 0xFD87B5F28300CA0EULL,  -157,  -28 },
+    { 0xBCE5086492111AEBULL,  -130,  -20 },
+    { 0x8CBCCC096F5088CCULL,  -103,  -12 },
+    { 0xD1B71758E219652CULL,   -77,   -4 },
+    { 0x9C40000000000000ULL,   -50,    4 },
+    { 0xE8D4A51000000000ULL,   -24,   12 },
+    { 0xAD78EBC5AC620000ULL,     3,   20 },
+    { 0x813F3978F8940984ULL,    30,   28 },
+    { 0xC097CE7BC90715B3ULL,    56,   36 },
+    { 0x8F7E32CE7BEA5C70ULL,    83,   44 },
+    { 0xD5D238A4ABE98068ULL,   109,   52 },
+    { 0x9F4F2726179A2245ULL,   136,   60 },
+    { 0xED63A231D4C4FB27ULL,   162,   68 },
+    { 0xB0DE65388CC8ADA8ULL,   189,   76 },
+    { 0x83C7088E1AAB65DBULL,   216,   84 },
+    { 0xC45D1DF942711D9AULL,   242,   92 },
+    { 0x924D692CA61BE758ULL,   269,  100 },
+    { 0xDA01EE641A708DEAULL,   295,  108 },
+    { 0xA26DA3999AEF774AULL,   322,  116 },
+    { 0xF209787BB47D6B85ULL,   348,  124 },
+    { 0xB454E4A179DD1877ULL,   375,  132 },
+    { 0x865B86925B9BC5C2ULL,   402,  140 },
+    { 0xC83553C5C8965D3DULL,   428,  148 },
+    { 0x952AB45CFA97A0B3ULL,   455,  156 },
+    { 0xDE469FBD99A05FE3ULL,   481,  164 },
+    { 0xA59BC234DB398C25ULL,   508,  172 },
+    { 0xF6C69A72A3989F5CULL,   534,  180 },
+    { 0xB7DCBF5354E9BECEULL,   561,  188 },
+    { 0x88FCF317F22241E2ULL,   588,  196 },
+    { 0xCC20CE9BD35C78A5ULL,   614,  204 },
+    { 0x98165AF37B2153DFULL,   641,  212 },
+    { 0xE2A0B5DC971F303AULL,   667,  220 },
+    { 0xA8D9D1535CE3B396ULL,   694,  228 },
+    { 0xFB9B7CD9A4A7443CULL,   720,  236 },
+    { 0xBB764C4CA7A44410ULL,   747,  244 },
+    { 0x8BAB8EEFB6409C1AULL,   774,  252 },
+    { 0xD01FEF10A657842CULL,   800,  260 },
+    { 0x9B10A4E5E9913129ULL,   827,  268 },
+    { 0xE7109BFBA19C0C9DULL,   853,  276 },
+    { 0xAC2820D9623BF429ULL,   880,  284 },
+    { 0x80444B5E7AA7CF85ULL,   907,  292 },
+    { 0xBF21E44003ACDD2DULL,   933,  300 },
+    { 0x8E679C2F5E44FF8FULL,   960,  308 },
+    { 0xD433179D9C8CB841ULL,   986,  316 },
+    { 0x9E19DB92B4E31BA9ULL,  1013,  324 },
+};
+
+const int kCachedPowersMinDecimalExponent = -300;
+const int kCachedPowersDecimalStep = 8;
+
+// Scaling by the cached power brings the exponent into [kAlpha, kGamma], so the integral
+// part of the scaled value fits in 32 bits and the digits can be generated with integers
+const int kAlpha = -60;
+const int kGamma = -32;
+
+CachedPower CachedPowerForBinaryExponent(int e) {
+    // ceil(log10(2^(kAlpha - e - 1)))
+    const int f = kAlpha - e - 1;
+    const int k = (f * 78913) / (1 << 18) + (f > 0);
+    const int index = (-kCachedPowersMinDecimalExponent + k + (kCachedPowersDecimalStep - 1)) / kCachedPowersDecimalStep;
+    return kCachedPowers[index];
+}
+
+int LargestPowerOfTen(uint32_t n, uint32_t &power) {
+    static const uint32_t kPowers[] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+    };
+    int digits = 10;
+    while (digits > 1 and n < kPowers[digits - 1]) {
+        digits -= 1;
+    }
+    power = kPowers[digits - 1];
+    return digits;
+}
+
+// Moves the last digit towards the real value while it stays inside the rounding interval
+void RoundWeed(char *buffer, int length, uint64_t distance, uint64_t delta, uint64_t rest, uint64_t tenK) {
+    while (rest < distance and delta - rest >= tenK and
+           (rest + tenK < distance or distance - rest > rest + tenK - distance)) {
+        buffer[length - 1]--;
+        rest += tenK;
+    }
+}
+
+void GenerateDigits(char *buffer, int &length, int &decimalExponent, DiyFp low, DiyFp w, DiyFp high) {
+    uint64_t delta = (high - low).f;
+    uint64_t distance = (high - w).f;
+
+    const DiyFp one(1ULL << -high.e, high.e);
+    uint32_t integral = (uint32_t)(high.f >> -one.e);
+    uint64_t fractional = high.f & (one.f - 1);
+
+    uint32_t power;
+    int digits = LargestPowerOfTen(integral, power);
+
+    while (digits > 0) {
+        buffer[length++] = (char)('0' + integral / power);
+        integral %= power;
+        digits -= 1;
+
+        uint64_t rest = ((uint64_t)integral << -one.e) + fractional;
+        if (rest <= delta) {
+            decimalExponent += digits;
+            RoundWeed(buffer, length, distance, delta, rest, (uint64_t)power << -one.e);
+            return;
+        }
+        power /= 10;
+    }
+
+    int fractionalDigits = 0;
+    while (1) {
+        fractional *= 10;
+        buffer[length++] = (char)('0' + (fractional >> -one.e));
+        fractional &= one.f - 1;
+        fractionalDigits += 1;
+
+        delta *= 10;
+        distance *= 10;
+        if (fractional <= delta) {
+            break;
+        }
+    }
+
+    decimalExponent -= fractionalDigits;
+    RoundWeed(buffer, length, distance, delta, fractional, one.f);
+}
+
+// Shortest digits of a positive value: value ~= digits * 10^decimalExponent
+template<typename Float>
+void Grisu2(Float value, char *buffer, int &length, int &decimalExponent) {
+    Boundaries b = ComputeBoundaries(value);
+    CachedPower cached = CachedPowerForBinaryExponent(b.plus.e);
+    DiyFp c(cached.f, cached.e);
+
+    DiyFp w = b.w * c;
+    DiyFp low = b.minus * c;
+    DiyFp high = b.plus * c;
+
+    // the products are off by up to one unit, so stay safely inside the interval
+    length = 0;
+    decimalExponent = -cached.k;
+    GenerateDigits(buffer, length, decimalExponent, DiyFp(low.f + 1, low.e), w, DiyFp(high.f - 1, high.e));
+}
+
+// Lays out digits * 10^decimalExponent like %g would, but with every digit kept
+size_t LayOut(char *buffer, int length, int decimalExponent) {
+    const int kMinExponent = -4;
+    const int kMaxExponent = 15;
+
+    // position of the decimal point relative to the first digit
+    const int point = length + decimalExponent;
+
+    if (length <= point and point <= kMaxExponent) {
+        // 1234e2 -> 123400.0
+        memset(buffer + length, '0', point - length);
+        buffer[point] = '.';
+        buffer[point + 1] = '0';
+        return point + 2;
+    }
+
+    if (0 < point and point <= kMaxExponent) {
+        // 1234e-2 -> 12.34
+        memmove(buffer + point + 1, buffer + point, length - point);
+        buffer[point] = '.';
+        return length + 1;
+    }
+
+    if (kMinExponent < point and point <= 0) {
+        // 1234e-6 -> 0.001234
+        const int zeros = -point;
+        memmove(buffer + 2 + zeros, buffer, length);
+        buffer[0] = '0';
+        buffer[1] = '.';
+        memset(buffer + 2, '0', zeros);
+        return 2 + zeros + length;
+    }
+
+    // 1234e30 -> 1.234e+33
+    size_t size = 1;
+    if (length > 1) {
+        memmove(buffer + 2, buffer + 1, length - 1);
+        buffer[1] = '.';
+        size = length + 1;
+    }
+
+    int exponent = point - 1;
+    buffer[size++] = 'e';
+    buffer[size++] = exponent < 0 ? '-' : '+';
+    exponent = exponent < 0 ? -exponent : exponent;
+    if (exponent >= 100) {
+        buffer[size++] = (char)('0' + exponent / 100);
+        exponent %= 100;
+    }
+    buffer[size++] = kDigitPairs[2 * exponent];
+    buffer[size++] = kDigitPairs[2 * exponent + 1];
+    return size;
+}
+
+template<typename Float>
+size_t FormatFloatingPoint(Float value, char *buffer) {
+    if (not std::isfinite(value)) {
+        memcpy(buffer, "null", 4);
+        return 4;
+    }
+
+    size_t sign = 0;
+    if (std::signbit(value)) {
+        buffer[0] = '-';
+        sign = 1;
+        value = -value;
+    }
+
+    if (value == 0) {
+        memcpy(buffer + sign, "0.0", 3);
+        return sign + 3;
+    }
+
+    int length;
+    int decimalExponent;
+    Grisu2(value, buffer + sign, length, decimalExponent);
+    return sign + LayOut(buffer + sign, length, decimalExponent);
+}
+
+}  // namespace
+
+size_t FormatInteger(long long value, char *buffer) {
+    if (value < 0) {
+        buffer[0] = '-';
+        // negate in unsigned arithmetic so LLONG_MIN works
+        return 1 + FormatUnsigned(0ULL - (unsigned long long)value, buffer + 1);
+    }
+    return FormatUnsigned(value, buffer);
+}
+
+size_t FormatUnsigned(unsigned long long value, char *buffer) {
+    char digits[20];
+    char *end = digits + sizeof(digits);
+    char *begin = WriteDigitsBackwards(value, end);
+    memcpy(buffer, begin, end - begin);
+    return end - begin;
+}
+
+size_t FormatReal(double value, char *buffer) {
+    return FormatFloatingPoint(value, buffer);
+}
+
+size_t FormatReal(float value, char *buffer) {
+    return FormatFloatingPoint(value, buffer);
+}
+
+double WidenFloat(float value) {
+    if (not std::isfinite(value)) {
+        return value;
+    }
+
+    char buffer[kMaxNumberLength];
+    size_t size = FormatReal(value, buffer);
+    JSON result;
+    ParseNumber(buffer, buffer + size, result);
+    return (double)result;
+}
+
+}  // namespace autojson
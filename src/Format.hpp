@@ -0,0 +1,34 @@
+#ifndef AUTOJSON_FORMAT_HPP
+#define AUTOJSON_FORMAT_HPP
+
+#include <cstddef>
+
+namespace autojson {
+
+// Enough room for any number the formatters below write
+const size_t kMaxNumberLength = 32;
+
+// The formatters write into buffer, without a trailing NUL, and return the length.
+// They never allocate and never depend on the locale.
+
+size_t FormatInteger(long long value, char *buffer);
+
+size_t FormatUnsigned(unsigned long long value, char *buffer);
+
+// Shortest text that reads back as exactly value (Grisu2). Integral values keep
+// a ".0" so they are read back as reals. NaN and infinities are written as null.
+size_t FormatReal(double value, char *buffer);
+
+// Same, with the digits chosen for a float: 0.1f is written as 0.1
+size_t FormatReal(float value, char *buffer);
+
+// The double closest to the shortest decimal text of value, so 0.1f becomes 0.1
+double WidenFloat(float value);
+
+}  // namespace autojson
+
+#ifndef autojsonuselib
+#include "autojson_src/Format.cpp"
+#endif
+
+#endif // AUTOJSON_FORMAT_HPP
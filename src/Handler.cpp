@@ -0,0 +1,162 @@
+#include "Handler.hpp"
+
+#include <cstring>
+
+#include "Instrument.hpp"
+#include "JSON.hpp"
+#include "Parse.hpp"
+
+namespace autojson {
+
+namespace {
+
+// Same grammar as JSONBuilder::parse, emitting events instead of nodes
+class EventParser {
+public:
+    explicit EventParser(JSONHandler &handler) : handler(handler) { }
+
+    bool parse(const char *&content) {
+        SkipWhitespace(content, ",");
+
+        if (*content == '\0') {
+            ParseError("Unexpected EOF", content);
+            return false;
+        }
+
+        bool result;
+        if (*content == '{') {
+            result = this->parseObject(content);
+        } else if (*content == '[') {
+            result = this->parseVector(content);
+        } else if (*content == '\"' or *content == '\'') {
+            ParseString(content, this->buffer);
+            result = this->handler.string(this->buffer.data(), this->buffer.size());
+        } else {
+            const char *start = content;
+            SkipWord(content);
+            result = this->primitive(start, content - start);
+        }
+
+        SkipWhitespace(content, ",");
+        return result;
+    }
+
+private:
+    JSONHandler &handler;
+    std::string buffer;
+
+    bool parseVector(const char *&content) {
+        if (not this->handler.startArray()) {
+            return false;
+        }
+
+        content++; // skip [
+
+        while (1) {
+            SkipWhitespace(content, ",");
+            if (*content == ']') {
+                content++;
+                break;
+            }
+
+            if (not this->parse(content)) {
+                return false;
+            }
+        }
+
+        return this->handler.endArray();
+    }
+
+    bool parseObject(const char *&content) {
+        if (not this->handler.startObject()) {
+            return false;
+        }
+
+        content++; // skip {
+
+        while (1) {
+            SkipWhitespace(content, ",");
+            if (*content == '}') {
+                content++;
+                break;
+            }
+
+            if (*content != '\"' and *content != '\'') {
+                ParseError("Expected a key. Got something else", content);
+                return false;
+            }
+
+            ParseString(content, this->buffer);
+            if (not this->handler.key(this->buffer.data(), this->buffer.size())) {
+                return false;
+            }
+
+            SkipWhitespace(content, ""); // get to :
+            if (*content != ':') {
+                ParseError("Expected ':'. Got something else", content);
+                return false;
+            }
+
+            content++;
+            if (not this->parse(content)) {
+                return false;
+            }
+        }
+
+        return this->handler.endObject();
+    }
+
+    bool primitive(const char *word, size_t size) {
+        if (size == 0) {
+            ParseError("Unexpected character", word);
+            return false;
+        }
+
+        return EmitWord(word, size, this->handler);
+    }
+};
+
+}  // namespace
+
+bool EmitWord(const char *word, size_t size, JSONHandler &handler) {
+    if (size == 4 and memcmp(word, "null", 4) == 0) {
+        return handler.null();
+    }
+    if (size == 4 and memcmp(word, "true", 4) == 0) {
+        return handler.boolean(true);
+    }
+    if (size == 5 and memcmp(word, "false", 5) == 0) {
+        return handler.boolean(false);
+    }
+
+    // numbers are decoded into a scalar node, which never allocates
+    JSON number;
+    if (not ParseNumber(word, word + size, number)) {
+        return handler.raw(word, size);
+    }
+
+    switch (number.primitiveType()) {
+        case JSONPrimitiveType::INTEGER:
+            return handler.integer((long long)number);
+        case JSONPrimitiveType::UNSIGNED:
+            return handler.unsignedInteger((unsigned long long)number);
+        default:
+            return handler.real((double)number);
+    }
+}
+
+bool ParseEvents(const char *&content, JSONHandler &handler) {
+    AUTOJSON_TIME(PARSE_TIME);
+    const char *start = content;
+    EventParser parser(handler);
+    bool ok = parser.parse(content);
+    AUTOJSON_COUNT(BYTES_PARSED, content - start);
+    return ok;
+}
+
+bool ParseEvents(const std::string &content, JSONHandler &handler) {
+    const char *content_p = content.c_str();
+    return ParseEvents(content_p, handler);
+}
+
+}  // namespace autojson
@@ -0,0 +1,75 @@
+#ifndef AUTOJSON_INSTRUMENT_HPP
+#define AUTOJSON_INSTRUMENT_HPP
+
+#include "Stats.hpp"
+
+#ifdef AUTOJSON_STATS
+
+#include <atomic>
+#include <chrono>
+
+namespace autojson {
+namespace internal {
+
+// Latencies up to 2^(kLatencyBuckets - 1) ns, about 9 minutes; longer ones go in the last bucket
+static const int kLatencyBuckets = 40;
+
+// Counts of one thread. Only that thread writes them, so an update is a plain load and store,
+// and the atomics only let GetStats() read them while they change.
+struct ThreadStats {
+    std::atomic<unsigned long long> counters[COUNTER_COUNT];
+    std::atomic<unsigned long long> timerCounts[TIMER_COUNT];
+    std::atomic<unsigned long long> timerTotals[TIMER_COUNT];
+    std::atomic<unsigned long long> buckets[TIMER_COUNT][kLatencyBuckets];
+
+    // Registers with GetStats() for the life of the thread
+    ThreadStats();
+
+    ~ThreadStats();
+};
+
+inline ThreadStats& LocalStats() {
+    static thread_local ThreadStats stats;
+    return stats;
+}
+
+inline void Add(std::atomic<unsigned long long> &counter, unsigned long long amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+inline void Count(JSONCounter counter, unsigned long long amount) {
+    Add(LocalStats().counters[counter], amount);
+}
+
+void RecordLatency(JSONTimer timer, unsigned long long nanoseconds);
+
+// Records the time until the end of the scope
+class ScopedTimer {
+public:
+    explicit ScopedTimer(JSONTimer timer) : timer(timer), start(std::chrono::steady_clock::now()) { }
+
+    ~ScopedTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - this->start;
+        RecordLatency(this->timer, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+private:
+    JSONTimer timer;
+    std::chrono::steady_clock::time_point start;
+};
+
+}  // namespace internal
+}  // namespace autojson
+
+#define AUTOJSON_COUNT(counter, amount) ::autojson::internal::Count(counter, amount)
+#define AUTOJSON_TIME(timer) ::autojson::internal::ScopedTimer autojsonScopedTimer(timer)
+
+#else
+
+// sizeof keeps what only the count uses from being unused, without evaluating it
+#define AUTOJSON_COUNT(counter, amount) do { (void)sizeof(amount); } while (0)
+#define AUTOJSON_TIME(timer) do { } while (0)
+
+#endif
+
+#endif // AUTOJSON_INSTRUMENT_HPP
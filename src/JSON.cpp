@@ -1,73 +1,269 @@
 #include "JSON.hpp"
 
+#include <atomic>
+#include <cstring>
 #include <fstream>
 #include <ostream>
+#include <type_traits>
 #include <typeinfo>
+#include <utility>
 
+#include "Binary.hpp"
+#include "Builder.hpp"
+#include "Format.hpp"
 #include "Parse.hpp"
+#include "Path.hpp"
+#include "Writer.hpp"
 #include "Error.hpp"
+#include "Instrument.hpp"
 
 namespace autojson {
 
+namespace {
+
+// A shared payload is preceded by its reference count
+const size_t kSharedHeaderSize = alignof(std::max_align_t);
+
+std::atomic<uint32_t>& References(const void *payload) {
+    return *(std::atomic<uint32_t>*)((char*)payload - kSharedHeaderSize);
+}
+
+void* AllocateShared(size_t size) {
+    AUTOJSON_COUNT(NODES_ALLOCATED, 1);
+    char *memory = (char*)::operator new(kSharedHeaderSize + size);
+    new (memory) std::atomic<uint32_t>(1);
+    return memory + kSharedHeaderSize;
+}
+
+template<typename T, typename Source>
+T* NewShared(Source &&source) {
+    return new (AllocateShared(sizeof(T))) T(std::forward<Source>(source));
+}
+
+template<typename T>
+void ReleaseShared(T *payload) {
+    if (References(payload).fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        AUTOJSON_COUNT(NODES_FREED, 1);
+        payload->~T();
+        ::operator delete((char*)payload - kSharedHeaderSize);
+    }
+}
+
+}  // namespace
+
 /// Generic
 
 JSON::JSON(JSONType type)
-    : type(type), content(nullptr) {
+    : type(type), primitive(JSONPrimitiveType::RAW), flags(0), inlineSize(0) {
     if (this->type == JSONType::STRING) {
-        this->content = new std::string("");
+        this->setText("", 0);
     } else if (this->type == JSONType::PRIMITIVE) {
-        this->content = new std::string("0");
+        this->primitive = JSONPrimitiveType::INTEGER;
+        this->integer = 0;
     } else if (this->type == JSONType::VECTOR) {
-        this->content = new std::vector<JSON>;
+        AUTOJSON_COUNT(NODES_ALLOCATED, 1);
+        this->vector = new Vector;
     } else {
-        this->content = new std::map<std::string, JSON>;
-    }
-}
-
-JSON::~JSON() {
-    if (this->type == JSONType::PRIMITIVE || this->type == JSONType::STRING) {
-        delete (std::string*)(this->content);
-    } else if (this->type == JSONType::VECTOR) {
-        delete (std::vector<JSON>*)(this->content);
-    } else if (this->type == JSONType::OBJECT) {
-        delete (std::map<std::string, JSON>*)(this->content);
+        AUTOJSON_COUNT(NODES_ALLOCATED, 1);
+        this->object = new Object;
     }
 }
 
-JSON::JSON(const JSON &rhs) {
-    *this = rhs;
+JSON::JSON(const char *c)
+    : JSON(c, strlen(c)) {
 }
 
-JSON& JSON::operator=(const JSON &rhs) {
-    this->type = rhs.type;
-    if (rhs.type == JSONType::PRIMITIVE || rhs.type == JSONType::STRING) {
-        this->content = new std::string(*(std::string*)(rhs.content));
+JSON::~JSON() {
+    this->release();
+}
+
+JSON::JSON(const JSON &rhs)
+    : type(rhs.type), primitive(rhs.primitive), flags(0), inlineSize(0) {
+    if (rhs.flags & SHARED) {
+        // every copy reads the same payload until one of them is written to
+        References(rhs.payload()).fetch_add(1, std::memory_order_relaxed);
+        this->flags = SHARED;
+        memcpy(this->inlineText, rhs.inlineText, kInlineTextCapacity);
+    } else if (rhs.type == JSONType::STRING || (rhs.type == JSONType::PRIMITIVE && rhs.primitive == JSONPrimitiveType::RAW)) {
+        this->setText(rhs.textData(), rhs.textSize());
     } else if (rhs.type == JSONType::VECTOR) {
-        this->content = new std::vector<JSON>(*(std::vector<JSON>*)(rhs.content));
+        AUTOJSON_COUNT(NODES_ALLOCATED, 1);
+        AUTOJSON_COUNT(DEEP_COPIES, 1);
+        this->vector = new Vector(*rhs.vector);
     } else if (rhs.type == JSONType::OBJECT) {
-        this->content = new std::map<std::string, JSON>(*(std::map<std::string, JSON>*)(rhs.content));
+        AUTOJSON_COUNT(NODES_ALLOCATED, 1);
+        AUTOJSON_COUNT(DEEP_COPIES, 1);
+        this->object = new Object(*rhs.object);
     } else {
-        this->content = nullptr;
+        this->unsignedInteger = rhs.unsignedInteger;
     }
+}
 
+JSON& JSON::operator=(const JSON &rhs) {
+    if (this == &rhs) {
+        return *this;
+    }
+
+    // rhs may live inside this node's payload, so copy it before releasing anything
+    JSON copy(rhs);
+    this->release();
+    this->takeFrom(copy);
     return *this;
 }
 
-JSON::JSON(JSON &&rhs) {
-    *this = std::move(rhs);
+JSON::JSON(JSON &&rhs) noexcept
+    : type(JSONType::INVALID), primitive(JSONPrimitiveType::RAW), flags(0), inlineSize(0) {
+    this->takeFrom(rhs);
 }
 
-JSON& JSON::operator=(JSON &&rhs) {
+JSON& JSON::operator=(JSON &&rhs) noexcept {
+    if (this == &rhs) {
+        return *this;
+    }
+
+    JSON moved(std::move(rhs));
+    this->release();
+    this->takeFrom(moved);
+    return *this;
+}
+
+void JSON::takeFrom(JSON &rhs) noexcept {
+    // the node is trivially relocatable: payload pointers simply change owner
     this->type = rhs.type;
-    this->content = rhs.content;
-    rhs.content = nullptr;
+    this->primitive = rhs.primitive;
+    this->flags = rhs.flags;
+    this->inlineSize = rhs.inlineSize;
+    memcpy(this->inlineText, rhs.inlineText, kInlineTextCapacity);
+
     rhs.type = JSONType::INVALID;
-    return *this;
+    rhs.primitive = JSONPrimitiveType::RAW;
+    rhs.flags = 0;
 }
 
-JSON::JSON(std::initializer_list<JSON> list) {
-    auto vp = new std::vector<JSON>;
+void JSON::setText(const char *data, size_t size) {
+    if (size <= kInlineTextCapacity) {
+        this->flags |= INLINE_TEXT;
+        this->inlineSize = (unsigned char)size;
+        memcpy(this->inlineText, data, size);
+    } else {
+        AUTOJSON_COUNT(NODES_ALLOCATED, 1);
+        this->flags &= ~INLINE_TEXT;
+        this->text.data = new char[size];
+        this->text.size = size;
+        memcpy(this->text.data, data, size);
+    }
+}
+
+void JSON::release() {
+    if (this->flags & ARENA) {
+        // freed together with the arena
+    } else if (this->flags & SHARED) {
+        if (this->type == JSONType::VECTOR) {
+            ReleaseShared(this->vector);
+        } else if (this->type == JSONType::OBJECT) {
+            ReleaseShared(this->object);
+        } else {
+            ReleaseShared(this->text.data);
+        }
+    } else if (this->type == JSONType::STRING || (this->type == JSONType::PRIMITIVE && this->primitive == JSONPrimitiveType::RAW)) {
+        if (not (this->flags & INLINE_TEXT)) {
+            AUTOJSON_COUNT(NODES_FREED, 1);
+            delete[] this->text.data;
+        }
+    } else if (this->type == JSONType::VECTOR) {
+        AUTOJSON_COUNT(NODES_FREED, 1);
+        delete this->vector;
+    } else if (this->type == JSONType::OBJECT) {
+        AUTOJSON_COUNT(NODES_FREED, 1);
+        delete this->object;
+    }
+
+    this->type = JSONType::INVALID;
+    this->primitive = JSONPrimitiveType::RAW;
+    this->flags = 0;
+}
+
+void* JSON::payload() const {
+    if (this->type == JSONType::VECTOR) {
+        return this->vector;
+    } else if (this->type == JSONType::OBJECT) {
+        return this->object;
+    } else {
+        return this->text.data;
+    }
+}
+
+void JSON::share() {
+    if (this->flags & ARENA) {
+        // the copies may outlive the arena
+        *this = JSON(*this);
+    }
+
+    if ((this->flags & SHARED) and References(this->payload()).load(std::memory_order_acquire) > 1) {
+        // other owners may be reading the children right now, they were shared with this node
+        return;
+    }
+
+    if (this->type == JSONType::VECTOR) {
+        for (JSON &itr : *this->vector) {
+            itr.share();
+        }
+        if (not (this->flags & SHARED)) {
+            Vector *shared = NewShared<Vector>(std::move(*this->vector));
+            AUTOJSON_COUNT(NODES_FREED, 1);
+            delete this->vector;
+            this->vector = shared;
+        }
+    } else if (this->type == JSONType::OBJECT) {
+        for (auto &itr : *this->object) {
+            itr.value.share();
+        }
+        if (not (this->flags & SHARED)) {
+            Object *shared = NewShared<Object>(std::move(*this->object));
+            AUTOJSON_COUNT(NODES_FREED, 1);
+            delete this->object;
+            this->object = shared;
+        }
+    } else if ((this->type == JSONType::STRING or
+                (this->type == JSONType::PRIMITIVE and this->primitive == JSONPrimitiveType::RAW)) and
+               not (this->flags & (INLINE_TEXT | SHARED))) {
+        char *shared = (char*)AllocateShared(this->text.size);
+        memcpy(shared, this->text.data, this->text.size);
+        AUTOJSON_COUNT(NODES_FREED, 1);
+        delete[] this->text.data;
+        this->text.data = shared;
+    } else {
+        // everything else is stored in the node itself
+        return;
+    }
+
+    this->flags |= SHARED;
+}
+
+void JSON::unshare() {
+    if (not (this->flags & SHARED) or References(this->payload()).load(std::memory_order_acquire) == 1) {
+        return;
+    }
+
+    // text is never written in place, so only containers need a copy; copying their
+    // children only bumps the reference counts of the shared ones
+    if (this->type == JSONType::VECTOR) {
+        Vector *copy = NewShared<Vector>(*this->vector);
+        ReleaseShared(this->vector);
+        this->vector = copy;
+    } else if (this->type == JSONType::OBJECT) {
+        Object *copy = NewShared<Object>(*this->object);
+        ReleaseShared(this->object);
+        this->object = copy;
+    }
+}
+
+JSON::JSON(std::initializer_list<JSON> list)
+    : type(JSONType::INVALID), primitive(JSONPrimitiveType::RAW), flags(0), inlineSize(0) {
+    AUTOJSON_COUNT(NODES_ALLOCATED, 1);
+    auto vp = new Vector;
     auto &v = *vp;
+    v.reserve(list.size());
 
     bool isObject = true;
     for (auto& itr : list) {
@@ -80,55 +276,29 @@ JSON::JSON(std::initializer_list<JSON> list) {
     }
 
     if (isObject) {
-        auto mp = new std::map<std::string, JSON>;
-        auto& m = *mp;
+        AUTOJSON_COUNT(NODES_ALLOCATED, 1);
+        this->type = JSONType::OBJECT;
+        this->object = new Object;
         for (auto& itr : v) {
-            m[itr[0]] = itr[1];
+            this->object->append(std::string_view(itr[0].textData(), itr[0].textSize())) = std::move(itr[1]);
         }
-
-        this->type = JSONType::OBJECT;
-        this->content = mp;
+        this->object->finish();
+        AUTOJSON_COUNT(NODES_FREED, 1);
         delete vp;
     } else {
         this->type = JSONType::VECTOR;
-        this->content = vp;
+        this->vector = vp;
     }
 }
 
 /// Parser for generic JSON
 JSON JSON::parse(const char*& content) {
-    auto CurrentChar = [&]() {
-        return *content;
-    };
-
-    auto Eof = [&]() {
-        return (*content == '\0');
-    };
-
-    SkipWhitespace(content, ",");
-
-    if (Eof()) {
-        ParseError("Unexpected EOF", content);
-    }
-
-    if (CurrentChar() == '{') {
-        auto r =  parseObject(content);
-        SkipWhitespace(content, ",");
-        return r;
-    } else if (CurrentChar() == '[') {
-        auto r = parseVector(content);
-        SkipWhitespace(content, ",");
-        return r;
-    } else if (CurrentChar() == '\"' or CurrentChar() == '\'') {
-        auto word = ParseString(content);
-        SkipWhitespace(content, ",");
-        return JSON(JSONType::STRING, new std::string(word));
-    } else {
-        auto word = ParseWord(content);
-        JSON j;
-        SkipWhitespace(content, ",");
-        return JSON(JSONType::PRIMITIVE, new std::string(word));
-    }
+    AUTOJSON_TIME(PARSE_TIME);
+    const char *start = content;
+    JSONBuilder builder;
+    JSON result = builder.parse(content);
+    AUTOJSON_COUNT(BYTES_PARSED, content - start);
+    return result;
 }
 
 JSON JSON::parse(const std::string& content) {
@@ -136,6 +306,28 @@ JSON JSON::parse(const std::string& content) {
     return parse(content_p);
 }
 
+JSON JSON::parseIndexed(const char* content, size_t size) {
+    AUTOJSON_TIME(PARSE_TIME);
+    AUTOJSON_COUNT(BYTES_PARSED, size);
+    JSONBuilder builder;
+    return builder.parseIndexed(content, size);
+}
+
+JSON JSON::parseIndexed(const std::string& content) {
+    return parseIndexed(content.data(), content.size());
+}
+
+JSON JSON::tryParse(const char* content, size_t size, ParseResult& result) {
+    AUTOJSON_TIME(PARSE_TIME);
+    AUTOJSON_COUNT(BYTES_PARSED, size);
+    JSONBuilder builder;
+    return builder.tryParse(content, size, result);
+}
+
+JSON JSON::tryParse(const std::string& content, ParseResult& result) {
+    return tryParse(content.data(), content.size(), result);
+}
+
 JSON JSON::readFromFile(const std::string& file) {
     std::ifstream fin(file, std::ios::in | std::ios::binary);
     std::string file_information;
@@ -156,27 +348,69 @@ JSON JSON::readFromFile(const std::string& file) {
     return parse(content_p);
 }
 
-void JSON::stringify(StringifyPart part) const {
-    if (this->type == JSONType::PRIMITIVE) {
-        this->stringifyPrimitive(part);
-    } else if (this->type == JSONType::STRING) {
-        this->stringifyString(part);
-    } else if (this->type == JSONType::VECTOR) {
-        this->stringifyVector(part);
-    } else if (this->type == JSONType::OBJECT) {
-        this->stringifyObject(part);
-    } else {
-        JSONError("Cannot Stringify an invalid JSON");
-    }
-}
-
 std::string JSON::stringify(int shrink) const {
     std::string result;
-    StringifyPart part(result, 0, shrink, false);
-    this->stringify(part);
+    this->stringify(result, shrink);
     return result;
 }
 
+void JSON::stringify(std::string &output, bool shrink) const {
+    AUTOJSON_TIME(STRINGIFY_TIME);
+    size_t start = output.size();
+    {
+        JSONWriter writer(output, shrink);
+        writer.write(*this);
+    }
+    AUTOJSON_COUNT(BYTES_EMITTED, output.size() - start);
+}
+
+std::string JSON::toCBOR() const {
+    std::string output;
+    this->toCBOR(output);
+    return output;
+}
+
+void JSON::toCBOR(std::string &output) const {
+    BinaryWriter writer(output, CBOR);
+    writer.write(*this);
+}
+
+JSON JSON::fromCBOR(const char *data, size_t size) {
+    return ParseBinary(data, data + size, CBOR);
+}
+
+JSON JSON::fromCBOR(const std::string &data) {
+    return JSON::fromCBOR(data.data(), data.size());
+}
+
+std::string JSON::toMessagePack() const {
+    std::string output;
+    this->toMessagePack(output);
+    return output;
+}
+
+void JSON::toMessagePack(std::string &output) const {
+    BinaryWriter writer(output, MESSAGE_PACK);
+    writer.write(*this);
+}
+
+JSON JSON::fromMessagePack(const char *data, size_t size) {
+    return ParseBinary(data, data + size, MESSAGE_PACK);
+}
+
+JSON JSON::fromMessagePack(const std::string &data) {
+    return JSON::fromMessagePack(data.data(), data.size());
+}
+
+std::ostream& operator<<(std::ostream &os, const JSON &json) {
+    // the bytes are counted by the writer as it flushes them
+    AUTOJSON_TIME(STRINGIFY_TIME);
+    StreamSink sink(os);
+    JSONWriter writer(sink);
+    writer.write(json);
+    return os;
+}
+
 void JSON::checkType(JSONType type) const {
     if (type != this->type) {
         JSONError(
@@ -191,25 +425,37 @@ void JSON::checkTypeAndSetIfInvalid(JSONType type) {
         (*this) = JSON(type);
     } else {
         this->checkType(type);
+        this->unshare();
     }
 }
 
 /// JSON Primitive
-void JSON::stringifyPrimitive(StringifyPart part) const {
-    part.indent();
-    part.result += *((std::string*)content);
+JSON JSON::rawPrimitive(const char *text, size_t size) {
+    JSON j(JSONPrimitiveType::RAW);
+    j.setText(text, size);
+    return j;
 }
 
 // Make the bool operator differently than the others
 // In case the JSON is invalid (the field is not present in a map) returns false
 JSON::operator bool() const {
+    AUTOJSON_COUNT(NUMBER_CONVERSIONS, 1);
     if (this->type == JSONType::PRIMITIVE) {
-        auto &txt = *(std::string *) (this->content);
-        bool val = false;
-        if (txt == "true" || txt == "1") {
-            val = true;
+        switch (this->primitive) {
+            case JSONPrimitiveType::NULL_VALUE:
+                return false;
+            case JSONPrimitiveType::BOOLEAN:
+                return this->boolean;
+            case JSONPrimitiveType::INTEGER:
+                return this->integer == 1;
+            case JSONPrimitiveType::UNSIGNED:
+                return this->unsignedInteger == 1;
+            case JSONPrimitiveType::REAL:
+                return this->real == 1;
+            default:
+                std::string txt(this->textData(), this->textSize());
+                return txt == "true" || txt == "1";
         }
-        return val;
     } else if (this->type == JSONType::INVALID) {
         return false;
     } else {
@@ -218,71 +464,88 @@ JSON::operator bool() const {
     }
 }
 
-JSON::operator int() const {
+template<typename T>
+T JSON::toNumber() const {
+    AUTOJSON_COUNT(NUMBER_CONVERSIONS, 1);
     this->checkType(JSONType::PRIMITIVE);
-    return std::stoi(*(std::string*)(this->content));
+    switch (this->primitive) {
+        case JSONPrimitiveType::NULL_VALUE:
+            return T(0);
+        case JSONPrimitiveType::BOOLEAN:
+            return T(this->boolean);
+        case JSONPrimitiveType::INTEGER:
+            return T(this->integer);
+        case JSONPrimitiveType::UNSIGNED:
+            return T(this->unsignedInteger);
+        case JSONPrimitiveType::REAL:
+            return T(this->real);
+        default:
+            break;
+    }
+
+    std::string txt(this->textData(), this->textSize());
+    if (std::is_floating_point<T>::value) {
+        return T(std::stold(txt));
+    } else if (std::is_signed<T>::value) {
+        return T(std::stoll(txt));
+    } else {
+        return T(std::stoull(txt));
+    }
+}
+
+JSON::operator int() const {
+    return this->toNumber<int>();
 }
 
 JSON::operator long() const {
-    this->checkType(JSONType::PRIMITIVE);
-    return std::stol(*(std::string*)(this->content));
+    return this->toNumber<long>();
 }
 
 JSON::operator unsigned long() const {
-    this->checkType(JSONType::PRIMITIVE);
-    return std::stoul(*(std::string*)(this->content));
+    return this->toNumber<unsigned long>();
 }
 
 JSON::operator long long() const {
-    this->checkType(JSONType::PRIMITIVE);
-    return std::stoll(*(std::string*)(this->content));
+    return this->toNumber<long long>();
 }
 
 JSON::operator unsigned long long() const {
-    this->checkType(JSONType::PRIMITIVE);
-    return std::stoull(*(std::string*)(this->content));
+    return this->toNumber<unsigned long long>();
+}
+
+JSON::JSON(float f) : JSON(JSONPrimitiveType::REAL) {
+    this->real = WidenFloat(f);
 }
 
 JSON::operator float() const {
-    this->checkType(JSONType::PRIMITIVE);
-    return std::stof(*(std::string*)(this->content));
+    return this->toNumber<float>();
 }
 
 JSON::operator double() const {
-    this->checkType(JSONType::PRIMITIVE);
-    return std::stod(*(std::string*)(this->content));
+    return this->toNumber<double>();
 }
 
 JSON::operator long double() const {
-    this->checkType(JSONType::PRIMITIVE);
-    return std::stold(*(std::string*)(this->content));
+    return this->toNumber<long double>();
+}
+
+bool JSON::isNull() const {
+    return this->type == JSONType::PRIMITIVE and this->primitive == JSONPrimitiveType::NULL_VALUE;
 }
 
 bool JSON::isInteger() const {
-    return this->isReal() and ((std::string*)(this->content))->find('.') == std::string::npos;
+    return this->type == JSONType::PRIMITIVE and
+            (this->primitive == JSONPrimitiveType::INTEGER or this->primitive == JSONPrimitiveType::UNSIGNED);
 }
 
 bool JSON::isReal() const {
-    this->checkType(JSONType::PRIMITIVE);
-    try {
-        std::stod(*(std::string*)(this->content));
-        return true;
-    } catch(...) {
-        return false;
-    }   
+    return this->type == JSONType::PRIMITIVE and
+            (this->primitive == JSONPrimitiveType::INTEGER or this->primitive == JSONPrimitiveType::UNSIGNED or
+             this->primitive == JSONPrimitiveType::REAL);
 }
 
 bool JSON::isBool() const {
-    if (this->type != JSONType::PRIMITIVE) {
-        return false;
-    }
-
-    auto& txt = *(std::string*)(this->content);
-    if (txt == "true" || txt == "false") {
-        return true;
-    }
-
-    return false;
+    return this->type == JSONType::PRIMITIVE and this->primitive == JSONPrimitiveType::BOOLEAN;
 }
 
 bool JSON::isHex() const {
@@ -290,10 +553,11 @@ bool JSON::isHex() const {
         return false;
     }
 
-    auto& txt = *(std::string*)(this->content);
+    const char* txt = this->textData();
     bool ok = true;
 
-    for (auto c : txt) {
+    for (size_t i = 0; i < this->textSize(); i += 1) {
+        char c = txt[i];
         if ('0' <= c and c <= '9') {
         } else if ('A' <= c and c <= 'F') {
         } else if ('a' <= c and c <= 'f') {
@@ -307,19 +571,19 @@ bool JSON::isHex() const {
 }
 
 bool JSON::isHex16() const {
-    return this->isHex() and ((std::string*)(this->content))->size() == 16;
+    return this->isHex() and this->textSize() == 16;
 }
 
 bool JSON::isHex32() const {
-    return this->isHex() and ((std::string*)(this->content))->size() == 32;
+    return this->isHex() and this->textSize() == 32;
 }
 
 bool JSON::isHex64() const {
-    return this->isHex() and ((std::string*)(this->content))->size() == 64;
+    return this->isHex() and this->textSize() == 64;
 }
 
 bool JSON::isHex128() const {
-    return this->isHex() and ((std::string*)(this->content))->size() == 128;
+    return this->isHex() and this->textSize() == 128;
 }
 
 bool JSON::isString() const {
@@ -334,155 +598,150 @@ bool JSON::isObject() const {
     return this->type == JSONType::OBJECT;
 }
 
-bool JSON::isInteger(const std::string& key) const {
-    return this->exists(key) && this->get(key).isInteger();
-}
-
-bool JSON::isReal(const std::string& key) const {
-    return this->exists(key) && this->get(key).isReal();
+bool JSON::isNull(std::string_view key) const {
+    this->checkType(JSONType::OBJECT);
+    const JSON* value = this->find(key);
+    return value != nullptr and value->isNull();
 }
 
-bool JSON::isBool(const std::string& key) const {
-    return this->exists(key) && this->get(key).isBool();
+bool JSON::isInteger(std::string_view key) const {
+    this->checkType(JSONType::OBJECT);
+    const JSON* value = this->find(key);
+    return value != nullptr and value->isInteger();
 }
 
-bool JSON::isHex(const std::string& key) const {
-    return this->exists(key) && this->get(key).isHex();
+bool JSON::isReal(std::string_view key) const {
+    this->checkType(JSONType::OBJECT);
+    const JSON* value = this->find(key);
+    return value != nullptr and value->isReal();
 }
 
-bool JSON::isHex16(const std::string& key) const {
-    return this->exists(key) && this->get(key).isHex16();
+bool JSON::isBool(std::string_view key) const {
+    this->checkType(JSONType::OBJECT);
+    const JSON* value = this->find(key);
+    return value != nullptr and value->isBool();
 }
 
-bool JSON::isHex32(const std::string& key) const {
-    return this->exists(key) && this->get(key).isHex32();
+bool JSON::isHex(std::string_view key) const {
+    this->checkType(JSONType::OBJECT);
+    const JSON* value = this->find(key);
+    return value != nullptr and value->isHex();
 }
 
-bool JSON::isHex64(const std::string& key) const {
-    return this->exists(key) && this->get(key).isHex64();
+bool JSON::isHex16(std::string_view key) const {
+    this->checkType(JSONType::OBJECT);
+    const JSON* value = this->find(key);
+    return value != nullptr and value->isHex16();
 }
 
-bool JSON::isHex128(const std::string& key) const {
-    return this->exists(key) && this->get(key).isHex128();
+bool JSON::isHex32(std::string_view key) const {
+    this->checkType(JSONType::OBJECT);
+    const JSON* value = this->find(key);
+    return value != nullptr and value->isHex32();
 }
 
-bool JSON::isString(const std::string& key) const {
-    return this->exists(key) && this->get(key).isString();
+bool JSON::isHex64(std::string_view key) const {
+    this->checkType(JSONType::OBJECT);
+    const JSON* value = this->find(key);
+    return value != nullptr and value->isHex64();
 }
 
-bool JSON::isArray(const std::string& key) const {
-    return this->exists(key) && this->get(key).isArray();
+bool JSON::isHex128(std::string_view key) const {
+    this->checkType(JSONType::OBJECT);
+    const JSON* value = this->find(key);
+    return value != nullptr and value->isHex128();
 }
 
-bool JSON::isObject(const std::string& key) const {
-    return this->exists(key) && this->get(key).isObject();
+bool JSON::isString(std::string_view key) const {
+    this->checkType(JSONType::OBJECT);
+    const JSON* value = this->find(key);
+    return value != nullptr and value->isString();
 }
 
-bool JSON::exists(const std::string& key) const {
+bool JSON::isArray(std::string_view key) const {
     this->checkType(JSONType::OBJECT);
-
-    auto& m = *(std::map<std::string, JSON>*)(this->content);
-    return m.count(key);
+    const JSON* value = this->find(key);
+    return value != nullptr and value->isArray();
 }
 
-void JSON::set(const std::string& key, const JSON& value) {
-    this->checkTypeAndSetIfInvalid(JSONType::OBJECT);
-    auto& m = *(std::map<std::string, JSON>*)(this->content);
-    m[key] = value;
+bool JSON::isObject(std::string_view key) const {
+    this->checkType(JSONType::OBJECT);
+    const JSON* value = this->find(key);
+    return value != nullptr and value->isObject();
 }
 
-JSON& JSON::getOrSet(const std::string& key, const JSON& defaultValue) {
-    this->checkTypeAndSetIfInvalid(JSONType::OBJECT);
-    auto& m = *(std::map<std::string, JSON>*)(this->content);
-    auto itr = m.find(key);
-    if (itr != m.end()) {
-        return itr->second;
-    }
+bool JSON::exists(std::string_view key) const {
+    this->checkType(JSONType::OBJECT);
 
-    m[key] = defaultValue;
+    return this->find(key) != nullptr;
+}
 
-    return m[key];
+void JSON::set(std::string_view key, const JSON& value) {
+    (*this)[key] = value;
 }
 
-JSON JSON::get(const std::string& key, const JSON& defaultValue) const {
-    if (JSONType::OBJECT != this->type) {
-        return defaultValue;
+JSON& JSON::getOrSet(std::string_view key, const JSON& defaultValue) {
+    JSON& value = (*this)[key];
+    if (value.type == JSONType::INVALID) {
+        value = defaultValue;
     }
 
-    auto& m = *(std::map<std::string, JSON>*)(this->content);
-    auto itr = m.find(key);
+    return value;
+}
 
-    if (itr != m.end()) {
-        this->checkType(JSONType::OBJECT);
-        return itr->second;
+JSON JSON::get(std::string_view key, const JSON& defaultValue) const {
+    const JSON* value = this->find(key);
+    if (value != nullptr) {
+        return *value;
     } else {
         return defaultValue;
     }
 }
 
-void JSON::stringifyString(StringifyPart part) const {
-    part.indent();
-    part.result += "\"" + EscapeKeys(*((std::string*)content)) + "\"";
+JSONKeyOrder JSON::keyOrder() const {
+    this->checkType(JSONType::OBJECT);
+    return this->object->order();
 }
 
-JSON::operator std::string() const {
-    if (this->type == JSONType::STRING) {
-        return std::string(*(std::string*)(this->content));
-    } else {
-        return this->stringify();
-    }
+void JSON::setKeyOrder(JSONKeyOrder order) {
+    this->checkTypeAndSetIfInvalid(JSONType::OBJECT);
+    this->object->setOrder(order);
 }
 
-void JSON::stringifyVector(StringifyPart part) const {
-    this->checkType(JSONType::VECTOR);
-
-    part.indent();
-    part.result += "[";
-    part.endLine();
-
-    std::vector<JSON>* m = (std::vector<JSON>*)content;
-    bool atLeastOneElement = false;
-    for (auto itr : *m) {
-        atLeastOneElement = true;
-
-        itr.stringify(part.increaseIndent());
-        part.result += ",";
-        part.endLine();
+const JSON* JSON::find(std::string_view key) const {
+    if (this->type != JSONType::OBJECT) {
+        return nullptr;
     }
+    return this->object->find(key, HashKey(key.data(), key.size()));
+}
 
-    if (atLeastOneElement) {
-        part.deleteComma();
+const JSON* JSON::find(const Key &key) const {
+    if (this->type != JSONType::OBJECT) {
+        return nullptr;
     }
-
-    part.indent();
-    part.result += "]";
+    return this->object->find(key, key.hash());
 }
 
-JSON JSON::parseVector(const char *&content) {
-    auto v = new std::vector<JSON>;
-
-    JSON j;
-    j.type = JSONType::VECTOR;
-    j.content = v;
-
-    content++; // skip [
-
-    while (1) {
-        SkipWhitespace(content, ",");
-        if (*content == ']') {
-            content++;
-            break;
-        }
+const JSON* JSON::find(const Path &path) const {
+    return path.find(*this);
+}
 
-        v->emplace_back(JSON::parse(content));
+JSON::operator std::string() const {
+    if (this->type == JSONType::STRING) {
+        return std::string(this->textData(), this->textSize());
+    } else {
+        return this->stringify();
     }
+}
 
-    return j;
+JSON JSON::parseVector(const char *&content) {
+    JSONBuilder builder;
+    return builder.parseVector(content);
 }
 
 JSON& JSON::operator[](int key) {
     this->checkTypeAndSetIfInvalid(JSONType::VECTOR);
-    auto& v = *(std::vector<JSON>*)(this->content);
+    auto& v = *this->vector;
     if (0 <= key and key < (int)v.size()) {
         return v[key];
     } else {
@@ -496,151 +755,92 @@ JSON& JSON::operator[](int key) {
     }
 }
 
-std::vector<JSON>::iterator JSON::begin() {
+const JSON& JSON::operator[](int key) const {
+    static const JSON invalid;
     this->checkType(JSONType::VECTOR);
-    auto& v = *(std::vector<JSON>*)(this->content);
+    if (this->type == JSONType::VECTOR and 0 <= key and key < (int)this->vector->size()) {
+        return (*this->vector)[key];
+    }
+
+    if (this->type == JSONType::VECTOR) {
+        JSONError("Vector out of bounds " + std::to_string(key) + ":" + std::to_string(this->vector->size()));
+    }
+    return invalid;
+}
+
+JSON::Vector::iterator JSON::begin() {
+    this->checkType(JSONType::VECTOR);
+    this->unshare();
+    auto& v = *this->vector;
     return v.begin();
 }
 
-std::vector<JSON>::iterator JSON::end() {
+JSON::Vector::iterator JSON::end() {
     this->checkType(JSONType::VECTOR);
-    auto& v = *(std::vector<JSON>*)(this->content);
+    this->unshare();
+    auto& v = *this->vector;
     return v.end();
 }
 
-std::vector<JSON>::const_iterator JSON::begin() const {
+JSON::Vector::const_iterator JSON::begin() const {
     this->checkType(JSONType::VECTOR);
-    const auto& v = *(std::vector<JSON>*)(this->content);
+    const auto& v = *this->vector;
     return v.begin();
 }
 
-std::vector<JSON>::const_iterator JSON::end() const {
+JSON::Vector::const_iterator JSON::end() const {
     this->checkType(JSONType::VECTOR);
-    const auto& v = *(std::vector<JSON>*)(this->content);
+    const auto& v = *this->vector;
     return v.end();
 }
 
 int JSON::size() const {
     this->checkType(JSONType::VECTOR);
-    auto& v = *(std::vector<JSON>*)(this->content);
+    auto& v = *this->vector;
     return v.size();
 }
 
-void JSON::stringifyObject(StringifyPart part) const {
-    this->checkType(JSONType::OBJECT);
-
-    part.indent();
-    part.result += "{";
-    part.endLine();
-
-    std::map<std::string, JSON>* m = (std::map<std::string, JSON>*)content;
-
-    bool atLeastOneElement = false;
-    for (auto itr : *m) {
-        atLeastOneElement = true;
-        part.indent(1);
-        part.result += "\"" + itr.first + "\"";
-        part.result += ":";
-
-        itr.second.stringify(part.increaseIndent().isContinueLine());
-        part.result += ",";
-        part.endLine();
-    }
-
-    if (atLeastOneElement) {
-        part.deleteComma();
-    }
-
-    part.indent();
-    part.result += "}";
-}
-
 JSON JSON::parseObject(const char*& content) {
-    auto m = new std::map<std::string, JSON>;
-
-    JSON j;
-    j.type = JSONType::OBJECT;
-    j.content = m;
-
-    content++; // skip {
-
-    while (1) {
-        SkipWhitespace(content, ",");
-        if (*content == '}') {
-            content++;
-            break;
-        }
-
-        auto word = ParseString(content);
-        SkipWhitespace(content, ""); // get to :
-        if (*content != ':') {
-            ParseError("Expected ':'. Got something else", content);
-        }
-
-        content++;
-        (*m)[word] = parse(content);
-    }
-
-    return j;
+    JSONBuilder builder;
+    return builder.parseObject(content);
 }
 
 JSON& JSON::operator[](const std::string& key) {
-    this->checkTypeAndSetIfInvalid(JSONType::OBJECT);
-    auto& m = *(std::map<std::string, JSON>*)(this->content);
-    return m[key];
+    return (*this)[std::string_view(key)];
 }
 
 JSON& JSON::operator[](const char* key) {
-    return operator[](std::string(key));
+    return (*this)[std::string_view(key)];
 }
 
-StringifyPart StringifyPart::increaseIndent() {
-    return StringifyPart(this->result, this->indentLevel + 1, this->shrink, this->continueLine);
+JSON& JSON::operator[](std::string_view key) {
+    this->checkTypeAndSetIfInvalid(JSONType::OBJECT);
+    return this->object->slot(key, HashKey(key.data(), key.size()));
 }
 
-StringifyPart StringifyPart::isContinueLine() {
-    return StringifyPart(this->result, this->indentLevel, this->shrink, true);
+JSON& JSON::operator[](const Key& key) {
+    this->checkTypeAndSetIfInvalid(JSONType::OBJECT);
+    return this->object->slot(key, key.hash());
 }
 
-StringifyPart& StringifyPart::indent(int bonus) {
-    if (this->continueLine) {
-        this->continueLine = false;
-        return *this;
-    }
-
-    if (this->shrink) {
-        this->result += "";
-    } else {
-        this->result += std::string((this->indentLevel + bonus) * 4, ' ');
-    }
-    return *this;
+const JSON& JSON::operator[](const std::string& key) const {
+    return (*this)[std::string_view(key)];
 }
 
-StringifyPart& StringifyPart::endLine(){
-    this->continueLine = false;
-    if (not this->shrink) {
-        result += "\n";
-    }
-    return *this;
+const JSON& JSON::operator[](const char* key) const {
+    return (*this)[std::string_view(key)];
 }
 
-StringifyPart& StringifyPart::deleteComma() {
-    std::string erased = "";
-    while (result.size() and result.back() != ',') {
-        erased += result.back();
-        result.pop_back();
-    }
-
-    if (result.size()) {
-        result.pop_back();
-    }
-
-    while (erased.size()) {
-        result += erased.back();
-        erased.pop_back();
-    }
+const JSON& JSON::operator[](std::string_view key) const {
+    static const JSON invalid;
+    const JSON* value = this->find(key);
+    return value != nullptr ? *value : invalid;
+}
 
-    return *this;
+const JSON& JSON::operator[](const Key& key) const {
+    static const JSON invalid;
+    const JSON* value = this->find(key);
+    return value != nullptr ? *value : invalid;
 }
 
 }  // namespace autojson
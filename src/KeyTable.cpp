@@ -0,0 +1,149 @@
+#include "KeyTable.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+#include "Arena.hpp"
+
+namespace autojson {
+
+namespace {
+
+// Allocated once in the arena of the table, followed by the key itself
+struct InternedKey {
+    const char *data;
+    uint32_t size;
+    uint32_t hash;
+};
+
+bool Matches(const InternedKey *interned, const char *key, size_t size, uint32_t hash) {
+    return interned->hash == hash and interned->size == size and memcmp(interned->data, key, size) == 0;
+}
+
+// Open addressing over pointers, so a slot is filled with one atomic store
+struct Slots {
+    size_t mask;
+    std::atomic<const InternedKey*> *slots;
+    // the smaller table this one replaced, kept for the readers that may still probe it
+    const Slots *previous;
+};
+
+// Lookups read the slots without locking; only adding a key takes the mutex. When the table
+// grows, the old slots are kept for the readers that may still be probing them: keys are
+// never freed either, and all the old arrays together are smaller than the current one.
+class KeyTable {
+public:
+    const InternedKey* find(const char *key, size_t size, uint32_t hash) const {
+        const Slots *table = this->table.load(std::memory_order_acquire);
+        if (table == nullptr) {
+            return nullptr;
+        }
+
+        for (size_t i = hash & table->mask; ; i = (i + 1) & table->mask) {
+            const InternedKey *interned = table->slots[i].load(std::memory_order_acquire);
+            if (interned == nullptr) {
+                return nullptr;
+            }
+            if (Matches(interned, key, size, hash)) {
+                return interned;
+            }
+        }
+    }
+
+    const InternedKey* add(const char *key, size_t size, uint32_t hash, bool always) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        // another thread may have added it, or grown the table, since find()
+        const InternedKey *found = this->find(key, size, hash);
+        if (found != nullptr) {
+            return found;
+        }
+
+        if (not always and this->count >= kMaxInternedKeys) {
+            return nullptr;
+        }
+
+        // keep the load factor under 1/2
+        const Slots *table = this->table.load(std::memory_order_relaxed);
+        if (table == nullptr or 2 * (this->count + 1) > table->mask + 1) {
+            table = this->grow(table);
+        }
+
+        InternedKey *interned = (InternedKey*)this->memory.allocate(sizeof(InternedKey) + size + 1, alignof(InternedKey));
+        char *data = (char*)(interned + 1);
+        memcpy(data, key, size);
+        data[size] = '\0';
+        *interned = InternedKey{data, (uint32_t)size, hash};
+
+        size_t i = hash & table->mask;
+        while (table->slots[i].load(std::memory_order_relaxed) != nullptr) {
+            i = (i + 1) & table->mask;
+        }
+        table->slots[i].store(interned, std::memory_order_release);
+        this->count += 1;
+        return interned;
+    }
+
+private:
+    std::mutex mutex;
+    Arena memory;
+    std::atomic<const Slots*> table{nullptr};
+    size_t count = 0;
+
+    const Slots* grow(const Slots *old) {
+        size_t capacity = old == nullptr ? 256 : 2 * (old->mask + 1);
+        Slots *table = new Slots{capacity - 1, new std::atomic<const InternedKey*>[capacity](), old};
+
+        if (old != nullptr) {
+            for (size_t j = 0; j <= old->mask; j += 1) {
+                const InternedKey *interned = old->slots[j].load(std::memory_order_relaxed);
+                if (interned == nullptr) {
+                    continue;
+                }
+                size_t i = interned->hash & table->mask;
+                while (table->slots[i].load(std::memory_order_relaxed) != nullptr) {
+                    i = (i + 1) & table->mask;
+                }
+                table->slots[i].store(interned, std::memory_order_relaxed);
+            }
+        }
+
+        this->table.store(table, std::memory_order_release);
+        return table;
+    }
+};
+
+KeyTable& GetKeyTable() {
+    // never destroyed: objects released at exit still point into it
+    static KeyTable *table = new KeyTable;
+    return *table;
+}
+
+}  // namespace
+
+const char* InternKey(const char *key, size_t size, uint32_t hash, KeyInterning interning) {
+    if (interning != INTERN_ALWAYS and size > kMaxInternedKeySize) {
+        return nullptr;
+    }
+
+    // most lookups hit the same few keys again, so each thread remembers them
+    static thread_local const InternedKey *cache[256];
+    const InternedKey *&cached = cache[hash & 255];
+    if (cached != nullptr and Matches(cached, key, size, hash)) {
+        return cached->data;
+    }
+
+    KeyTable &table = GetKeyTable();
+    const InternedKey *interned = table.find(key, size, hash);
+    if (interned == nullptr and interning != INTERN_KNOWN_KEYS) {
+        interned = table.add(key, size, hash, interning == INTERN_ALWAYS);
+    }
+    if (interned == nullptr) {
+        return nullptr;
+    }
+    cached = interned;
+    return interned->data;
+}
+
+}  // namespace autojson
@@ -0,0 +1,36 @@
+#ifndef AUTOJSON_KEY_TABLE_HPP
+#define AUTOJSON_KEY_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace autojson {
+
+// Keys longer than this are not interned when parsing: they are more likely data than field names
+static const size_t kMaxInternedKeySize = 64;
+
+// Past this many keys the table stops growing, unless asked by a JSONKey
+static const size_t kMaxInternedKeys = 1 << 16;
+
+// Which keys InternKey adds to the table
+enum KeyInterning : unsigned char {
+    // short keys, while the table has room
+    INTERN_NEW_KEYS,
+    // none: only keys already there are shared, so untrusted input cannot fill the table
+    INTERN_KNOWN_KEYS,
+    // every key, even long ones and past the limit; for JSONKey
+    INTERN_ALWAYS
+};
+
+// Process-wide copy of key, shared by every object that has it and never freed.
+// Returns nullptr when the key is not in the table and is not added to it.
+// hash must be HashKey(key, size). Thread safe; finding a key that is already there never locks.
+const char* InternKey(const char *key, size_t size, uint32_t hash, KeyInterning interning = INTERN_NEW_KEYS);
+
+}  // namespace autojson
+
+#ifndef autojsonuselib
+#include "autojson_src/KeyTable.cpp"
+#endif
+
+#endif // AUTOJSON_KEY_TABLE_HPP
@@ -0,0 +1,295 @@
+#include "Lines.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#include "Builder.hpp"
+#include "Error.hpp"
+#include "Instrument.hpp"
+
+namespace autojson {
+
+namespace {
+
+struct ParsedLine {
+    size_t offset;
+    JSON value;
+};
+
+unsigned WorkerCount(unsigned jobs) {
+    return jobs != 0 ? jobs : std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool IsBlank(const char *data, size_t size) {
+    for (size_t i = 0; i < size; i += 1) {
+        if (data[i] != ' ' and data[i] != '\t' and data[i] != '\r') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Parses the lines in [begin, end) of content into lines
+void ParseChunk(JSONBuilder &builder, const char *content, size_t begin, size_t end, std::vector<ParsedLine> &lines) {
+    while (begin < end) {
+        const char *newLine = (const char*)memchr(content + begin, '\n', end - begin);
+        size_t lineEnd = newLine != nullptr ? newLine - content : end;
+        if (not IsBlank(content + begin, lineEnd - begin)) {
+            AUTOJSON_TIME(PARSE_TIME);
+            AUTOJSON_COUNT(BYTES_PARSED, lineEnd - begin);
+            lines.push_back(ParsedLine{begin, builder.parseIndexed(content + begin, lineEnd - begin)});
+        }
+        begin = lineEnd + 1;
+    }
+}
+
+}  // namespace
+
+/// JSONLinesReader
+
+JSONLinesReader::JSONLinesReader(unsigned jobs)
+    : content(nullptr), contentSize(0), mapped(false), jobs(WorkerCount(jobs)), chunkSize(kChunkSize) {
+}
+
+JSONLinesReader::~JSONLinesReader() {
+    this->close();
+}
+
+bool JSONLinesReader::open(const std::string &file_name) {
+    this->close();
+
+    int fd = ::open(file_name.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        JSONError("Cannot open " + file_name + ": " + strerror(errno));
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        ::close(fd);
+        JSONError("Cannot read " + file_name);
+        return false;
+    }
+
+    // an empty file cannot be mapped, and has no lines anyway
+    void *mapping = nullptr;
+    if (status.st_size > 0) {
+        mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+
+    if (mapping == MAP_FAILED) {
+        JSONError("Cannot map " + file_name);
+        return false;
+    }
+    if (mapping != nullptr) {
+        // the chunks are read from start to end, once
+        madvise(mapping, status.st_size, MADV_SEQUENTIAL);
+    }
+
+    this->content = (const char*)mapping;
+    this->contentSize = status.st_size;
+    this->mapped = mapping != nullptr;
+    return true;
+}
+
+void JSONLinesReader::open(const char *data, size_t size) {
+    this->close();
+    this->content = data;
+    this->contentSize = size;
+}
+
+void JSONLinesReader::close() {
+    if (this->mapped) {
+        munmap((void*)this->content, this->contentSize);
+    }
+    this->content = nullptr;
+    this->contentSize = 0;
+    this->mapped = false;
+}
+
+void JSONLinesReader::chunkBounds(size_t chunk, size_t &begin, size_t &end) const {
+    // a chunk owns the lines that start inside it
+    auto LineStart = [this](size_t position) {
+        if (position == 0 or position >= this->contentSize) {
+            return std::min(position, this->contentSize);
+        }
+        const char *newLine = (const char*)memchr(this->content + position - 1, '\n', this->contentSize - position + 1);
+        return newLine != nullptr ? (size_t)(newLine - this->content) + 1 : this->contentSize;
+    };
+
+    begin = LineStart(chunk * this->chunkSize);
+    end = LineStart((chunk + 1) * this->chunkSize);
+}
+
+size_t JSONLinesReader::read(const Handle &handle, JSONLinesOrder order) {
+    size_t chunks = (this->contentSize + this->chunkSize - 1) / this->chunkSize;
+    size_t count = 0;
+
+    if (this->jobs <= 1 or chunks <= 1) {
+        JSONBuilder builder;
+        std::vector<ParsedLine> lines;
+        for (size_t chunk = 0; chunk < chunks; chunk += 1) {
+            size_t begin, end;
+            this->chunkBounds(chunk, begin, end);
+            lines.clear();
+            ParseChunk(builder, this->content, begin, end, lines);
+            for (ParsedLine &line : lines) {
+                count += 1;
+                if (not handle(line.offset, line.value)) {
+                    return count;
+                }
+            }
+        }
+        return count;
+    }
+
+    // workers take the next chunk as long as it is close enough to the ones being handed out,
+    // and leave what they parsed in ready
+    std::mutex mutex;
+    std::condition_variable parsed;
+    std::condition_variable handedOut;
+    std::map<size_t, std::vector<ParsedLine>> ready;
+    size_t next = 0;
+    size_t done = 0;
+    bool stop = false;
+    const size_t window = 4 * (size_t)this->jobs;
+
+    auto Work = [&]() {
+        JSONBuilder builder;
+        while (true) {
+            size_t chunk;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                handedOut.wait(lock, [&]() {
+                    return stop or next >= chunks or next < done + window;
+                });
+                if (stop or next >= chunks) {
+                    return;
+                }
+                chunk = next++;
+            }
+
+            size_t begin, end;
+            this->chunkBounds(chunk, begin, end);
+            std::vector<ParsedLine> lines;
+            ParseChunk(builder, this->content, begin, end, lines);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready.emplace(chunk, std::move(lines));
+            }
+            parsed.notify_one();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < std::min<size_t>(this->jobs, chunks); i += 1) {
+        workers.emplace_back(Work);
+    }
+
+    while (done < chunks and not stop) {
+        std::vector<ParsedLine> lines;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            parsed.wait(lock, [&]() {
+                return order == ANY_ORDER ? not ready.empty() : ready.count(done) != 0;
+            });
+            auto chunk = order == ANY_ORDER ? ready.begin() : ready.find(done);
+            lines = std::move(chunk->second);
+            ready.erase(chunk);
+            done += 1;
+        }
+        handedOut.notify_all();
+
+        for (ParsedLine &line : lines) {
+            count += 1;
+            if (not handle(line.offset, line.value)) {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+                break;
+            }
+        }
+    }
+    handedOut.notify_all();
+
+    for (auto& itr : workers) {
+        itr.join();
+    }
+    return count;
+}
+
+std::vector<JSON> JSONLinesReader::readAll() {
+    std::vector<JSON> values;
+    this->read([&values](size_t, JSON &value) {
+        values.push_back(std::move(value));
+        return true;
+    });
+    return values;
+}
+
+/// JSONLinesWriter
+
+JSONLinesWriter::JSONLinesWriter(std::string &output, unsigned jobs)
+    : output(&output), sink(nullptr), jobs(WorkerCount(jobs)) {
+}
+
+JSONLinesWriter::JSONLinesWriter(JSONSink &sink, unsigned jobs)
+    : output(nullptr), sink(&sink), jobs(WorkerCount(jobs)) {
+}
+
+void JSONLinesWriter::write(const JSON &value) {
+    this->write(&value, 1);
+}
+
+void JSONLinesWriter::write(const JSON *values, size_t count) {
+    // a few parts per worker, so one slow part does not hold the others back
+    static const size_t kMinPartValues = 64;
+    size_t partCount = std::min<size_t>(4 * (size_t)this->jobs, (count + kMinPartValues - 1) / kMinPartValues);
+    partCount = std::max<size_t>(partCount, 1);
+    if (this->parts.size() < partCount) {
+        this->parts.resize(partCount);
+    }
+
+    std::atomic<size_t> next(0);
+    auto Work = [&]() {
+        for (size_t i = next++; i < partCount; i = next++) {
+            std::string &part = this->parts[i];
+            part.clear();
+            JSONWriter writer(part);
+            for (size_t j = count * i / partCount; j < count * (i + 1) / partCount; j += 1) {
+                writer.write(values[j]);
+                part += '\n';
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < std::min<size_t>(this->jobs, partCount); i += 1) {
+        workers.emplace_back(Work);
+    }
+    Work();
+    for (auto& itr : workers) {
+        itr.join();
+    }
+
+    for (size_t i = 0; i < partCount; i += 1) {
+        if (this->sink != nullptr) {
+            this->sink->write(this->parts[i].data(), this->parts[i].size());
+        } else {
+            *this->output += this->parts[i];
+        }
+    }
+}
+
+}  // namespace autojson
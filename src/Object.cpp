@@ -0,0 +1,339 @@
+#include "Object.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <utility>
+
+#include "Instrument.hpp"
+#include "KeyTable.hpp"
+
+namespace autojson {
+
+namespace {
+
+bool KeyEquals(const JSONObject::Entry &entry, std::string_view key, uint32_t hash) {
+    // interned keys are equal exactly when they are the same pointer
+    return entry.hash == hash and entry.keySize == key.size() and
+            (entry.keyData == key.data() or memcmp(entry.keyData, key.data(), key.size()) == 0);
+}
+
+bool EntryLess(const JSONObject::Entry &lhs, const JSONObject::Entry &rhs) {
+    return lhs.key() < rhs.key();
+}
+
+// Stable like std::stable_sort, but small ranges never allocate: objects are small and often built in an arena
+void SortEntries(JSONObject::iterator first, JSONObject::iterator last) {
+    if (last - first > (ptrdiff_t)JSONObject::kLinearScanLimit) {
+        std::stable_sort(first, last, EntryLess);
+        return;
+    }
+
+    for (auto i = first + (first != last); i < last; ++i) {
+        if (not EntryLess(*i, *(i - 1))) {
+            continue;
+        }
+
+        JSONObject::Entry moved = std::move(*i);
+        auto j = i;
+        for (; j > first and EntryLess(moved, *(j - 1)); --j) {
+            *j = std::move(*(j - 1));
+        }
+        *j = std::move(moved);
+    }
+}
+
+template<typename T>
+T Load(const char *p) {
+    T value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint64_t Mix(uint64_t x) {
+    x ^= x >> 32;
+    x *= 0xD6E8FEB86659FD93ULL;
+    x ^= x >> 32;
+    return x;
+}
+
+}  // namespace
+
+JSONKeyOrder& GetDefaultKeyOrder() {
+    static JSONKeyOrder order = SORTED_KEYS;
+    return order;
+}
+
+void SetDefaultKeyOrder(JSONKeyOrder order) {
+    GetDefaultKeyOrder() = order;
+}
+
+uint32_t HashKey(const char *key, size_t size) {
+    const uint64_t kMultiplier = 0x9E3779B97F4A7C15ULL;
+
+    // only fixed size loads, so nothing turns into a call to memcpy;
+    // the last load overlaps the previous bytes instead of reading a tail
+    const char *end = key + size;
+    uint64_t hash = size * kMultiplier;
+    if (size > 8) {
+        for (; end - key > 8; key += 8) {
+            hash = (hash ^ Load<uint64_t>(key)) * kMultiplier;
+        }
+        hash = (hash ^ Load<uint64_t>(end - 8)) * kMultiplier;
+    } else if (size >= 4) {
+        uint64_t word = Load<uint32_t>(key) | ((uint64_t)Load<uint32_t>(end - 4) << 32);
+        hash = (hash ^ word) * kMultiplier;
+    } else if (size > 0) {
+        uint64_t word = (unsigned char)key[0] | ((unsigned char)key[size / 2] << 8) | ((unsigned char)end[-1] << 16);
+        hash = (hash ^ word) * kMultiplier;
+    }
+
+    // multiplying only carries bits upwards, fold the high half back into the low bits
+    return (uint32_t)Mix(hash);
+}
+
+JSONKey::JSONKey(std::string_view key)
+    : length((uint32_t)key.size()), keyHash(HashKey(key.data(), key.size())) {
+    this->ptr = InternKey(key.data(), key.size(), this->keyHash, INTERN_ALWAYS);
+}
+
+JSONObject::JSONObject(const JSONObject &rhs)
+    : entries((rhs.sortKeys(), rhs.entries)), index(rhs.index), keyOrder(rhs.keyOrder),
+      sortedCount(rhs.sortedCount), unsorted(false) {
+    ArenaAllocator<char> allocator(this->entries.get_allocator());
+    for (Entry &entry : this->entries) {
+        if (entry.ownsKey) {
+            char *data = allocator.allocate(entry.keySize);
+            memcpy(data, entry.keyData, entry.keySize);
+            entry.keyData = data;
+        }
+    }
+}
+
+JSONObject::JSONObject(JSONObject &&rhs)
+    : entries(std::move(rhs.entries)), index(std::move(rhs.index)), keyOrder(rhs.keyOrder),
+      sortedCount(rhs.sortedCount), unsorted(rhs.unsorted.load(std::memory_order_relaxed)) {
+    rhs.sortedCount = 0;
+    rhs.unsorted.store(false, std::memory_order_relaxed);
+}
+
+JSONObject::~JSONObject() {
+    for (Entry &entry : this->entries) {
+        this->releaseKey(entry);
+    }
+}
+
+void JSONObject::setOrder(JSONKeyOrder order) {
+    this->sortKeys();
+    if (order == SORTED_KEYS and this->keyOrder != SORTED_KEYS) {
+        SortEntries(this->entries.begin(), this->entries.end());
+        this->rebuildIndex(this->entries.size());
+        this->sortedCount = this->entries.size();
+    }
+    this->keyOrder = order;
+}
+
+JSON* JSONObject::find(std::string_view key, uint32_t hash) {
+    // const JSON lookups get here too
+    this->sortKeys();
+    size_t position = this->position(key, hash, this->entries.size());
+    AUTOJSON_COUNT(KEY_LOOKUPS, 1);
+    AUTOJSON_COUNT(KEY_MISSES, position == npos);
+    return position != npos ? &this->entries[position].value : nullptr;
+}
+
+const JSON* JSONObject::find(std::string_view key, uint32_t hash) const {
+    // the entries must not move under another reader that sorts them
+    this->sortKeys();
+    size_t position = this->position(key, hash, this->entries.size());
+    AUTOJSON_COUNT(KEY_LOOKUPS, 1);
+    AUTOJSON_COUNT(KEY_MISSES, position == npos);
+    return position != npos ? &this->entries[position].value : nullptr;
+}
+
+JSON& JSONObject::slot(std::string_view key, uint32_t hash) {
+    size_t position = this->position(key, hash, this->entries.size());
+    AUTOJSON_COUNT(KEY_LOOKUPS, 1);
+    if (position != npos) {
+        return this->entries[position].value;
+    }
+    AUTOJSON_COUNT(KEY_MISSES, 1);
+
+    // added at the end, so the index stays valid; a key that sorts last keeps the object sorted
+    position = this->entries.size();
+    bool inOrder = this->keyOrder == INSERTION_ORDER or
+            (not this->unsorted.load(std::memory_order_relaxed) and
+             (this->entries.empty() or this->entries.back().key() < key));
+    this->emplaceEntry(this->entries.end(), key, hash);
+    if (inOrder) {
+        this->sortedCount = this->entries.size();
+    } else {
+        this->unsorted.store(true, std::memory_order_relaxed);
+    }
+
+    if (not this->index.empty()) {
+        this->insertIntoIndex(position, this->entries.size());
+    } else if (this->entries.size() > kLinearScanLimit) {
+        this->rebuildIndex(this->entries.size());
+    }
+
+    return this->entries[position].value;
+}
+
+JSON& JSONObject::append(std::string_view key, bool internNewKeys) {
+    this->emplaceEntry(this->entries.end(), key, HashKey(key.data(), key.size()), internNewKeys);
+    return this->entries.back().value;
+}
+
+void JSONObject::finish() {
+    this->index.clear();
+    size_t count = 0;
+
+    if (this->keyOrder == SORTED_KEYS) {
+        SortEntries(this->entries.begin(), this->entries.end());
+
+        // duplicates are next to each other, in the order they were appended
+        for (size_t i = 0; i < this->entries.size(); i += 1) {
+            Entry &entry = this->entries[i];
+            if (count > 0 and KeyEquals(this->entries[count - 1], entry.key(), entry.hash)) {
+                this->entries[count - 1].value = std::move(entry.value);
+                this->releaseKey(entry);
+            } else {
+                if (count != i) {
+                    this->entries[count] = std::move(this->entries[i]);
+                }
+                count += 1;
+            }
+        }
+
+        this->entries.erase(this->entries.begin() + count, this->entries.end());
+        this->rebuildIndex(count);
+        this->sortedCount = count;
+        this->unsorted.store(false, std::memory_order_relaxed);
+    } else {
+        // a duplicate keeps the place of the first occurrence
+        for (size_t i = 0; i < this->entries.size(); i += 1) {
+            Entry &entry = this->entries[i];
+            size_t previous = this->position(entry.key(), entry.hash, count);
+            if (previous != npos) {
+                this->entries[previous].value = std::move(entry.value);
+                this->releaseKey(entry);
+                continue;
+            }
+
+            if (count != i) {
+                this->entries[count] = std::move(this->entries[i]);
+            }
+            count += 1;
+
+            if (not this->index.empty()) {
+                this->insertIntoIndex(count - 1, count);
+            } else if (count > kLinearScanLimit) {
+                this->rebuildIndex(count);
+            }
+        }
+
+        // the index already covers exactly the kept entries
+        this->entries.erase(this->entries.begin() + count, this->entries.end());
+    }
+}
+
+void JSONObject::sortAdded() const {
+    // only taken the first time an object built with slot() is read, never held long
+    static std::mutex *mutex = new std::mutex;
+    std::lock_guard<std::mutex> lock(*mutex);
+    if (not this->unsorted.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    // the object itself is never const, only the reference readers have to it
+    JSONObject &self = const_cast<JSONObject&>(*this);
+    auto middle = self.entries.begin() + self.sortedCount;
+    SortEntries(middle, self.entries.end());
+    std::inplace_merge(self.entries.begin(), middle, self.entries.end(), EntryLess);
+    self.rebuildIndex(self.entries.size());
+    self.sortedCount = self.entries.size();
+    self.unsorted.store(false, std::memory_order_release);
+}
+
+size_t JSONObject::position(std::string_view key, uint32_t hash, size_t count) const {
+    if (this->index.empty()) {
+        for (size_t i = 0; i < count; i += 1) {
+            if (KeyEquals(this->entries[i], key, hash)) {
+                return i;
+            }
+        }
+        return npos;
+    }
+
+    const size_t mask = this->index.size() - 1;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+        const Slot &slot = this->index[i];
+        if (slot.position == 0) {
+            return npos;
+        }
+        if (slot.hash == hash and KeyEquals(this->entries[slot.position - 1], key, hash)) {
+            return slot.position - 1;
+        }
+    }
+}
+
+void JSONObject::emplaceEntry(iterator position, std::string_view key, uint32_t hash, bool internNewKeys) {
+    const char *interned = InternKey(key.data(), key.size(), hash, internNewKeys ? INTERN_NEW_KEYS : INTERN_KNOWN_KEYS);
+    if (interned != nullptr) {
+        this->entries.emplace(position, interned, key.size(), false, hash);
+        return;
+    }
+
+    char *data = ArenaAllocator<char>(this->entries.get_allocator()).allocate(key.size());
+    memcpy(data, key.data(), key.size());
+    this->entries.emplace(position, data, key.size(), true, hash);
+}
+
+void JSONObject::releaseKey(Entry &entry) {
+    if (entry.ownsKey) {
+        ArenaAllocator<char>(this->entries.get_allocator()).deallocate((char*)entry.keyData, entry.keySize);
+        entry.ownsKey = false;
+    }
+}
+
+void JSONObject::insertIntoIndex(size_t position, size_t count) {
+    // keep the load factor under 1/2
+    if (2 * count > this->index.size()) {
+        this->rebuildIndex(count);
+        return;
+    }
+
+    const uint32_t hash = this->entries[position].hash;
+    const size_t mask = this->index.size() - 1;
+    size_t i = hash & mask;
+    while (this->index[i].position != 0) {
+        i = (i + 1) & mask;
+    }
+    this->index[i] = Slot{(uint32_t)position + 1, hash};
+}
+
+void JSONObject::rebuildIndex(size_t count) {
+    if (count <= kLinearScanLimit) {
+        this->index.clear();
+        return;
+    }
+
+    size_t capacity = 64;
+    while (capacity < 2 * count) {
+        capacity *= 2;
+    }
+    this->index.assign(capacity, Slot{0, 0});
+
+    const size_t mask = capacity - 1;
+    for (size_t position = 0; position < count; position += 1) {
+        const uint32_t hash = this->entries[position].hash;
+        size_t i = hash & mask;
+        while (this->index[i].position != 0) {
+            i = (i + 1) & mask;
+        }
+        this->index[i] = Slot{(uint32_t)position + 1, hash};
+    }
+}
+
+}  // namespace autojson
@@ -0,0 +1,244 @@
+#include "OnDemand.hpp"
+
+namespace autojson {
+
+namespace {
+
+// Whitespace and commas, like JSONReader skips them
+const char* SkipSeparators(const char *content) {
+    while (*content == ' ' or *content == '\t' or *content == '\n' or *content == '\r' or *content == ',') {
+        content++;
+    }
+    return content;
+}
+
+}  // namespace
+
+/// JSONLazyValue
+
+JSONLazyValue::JSONLazyValue(const char *start, JSONLazyDocument *document)
+    : start(SkipSeparators(start)), document(document) {
+}
+
+JSONType JSONLazyValue::type() const {
+    if (this->start == nullptr) {
+        return JSONType::INVALID;
+    }
+
+    switch (*this->start) {
+        case '\0':
+            return JSONType::INVALID;
+        case '{':
+            return JSONType::OBJECT;
+        case '[':
+            return JSONType::VECTOR;
+        case '\"':
+        case '\'':
+            return JSONType::STRING;
+        default:
+            return JSONType::PRIMITIVE;
+    }
+}
+
+bool JSONLazyValue::isNull() const {
+    return this->type() == JSONType::PRIMITIVE and JSONReader(this->start).readScalar().isNull();
+}
+
+JSONLazyObject JSONLazyValue::object() const {
+    return JSONLazyObject(this->start, this->document);
+}
+
+JSONLazyArray JSONLazyValue::array() const {
+    return JSONLazyArray(this->start, this->document);
+}
+
+JSONLazyValue JSONLazyValue::operator[](std::string_view key) const {
+    return this->object().find(key);
+}
+
+JSONLazyValue JSONLazyValue::operator[](const std::string &key) const {
+    return (*this)[std::string_view(key)];
+}
+
+JSONLazyValue JSONLazyValue::operator[](const char *key) const {
+    return (*this)[std::string_view(key)];
+}
+
+JSONLazyValue JSONLazyValue::operator[](int index) const {
+    JSONLazyArray elements = this->array();
+    JSONLazyValue value;
+    for (int i = 0; i <= index; i += 1) {
+        if (not elements.next(value)) {
+            return JSONLazyValue();
+        }
+    }
+    return value;
+}
+
+std::string_view JSONLazyValue::text() const {
+    if (this->start == nullptr) {
+        return std::string_view();
+    }
+
+    JSONReader reader(this->start);
+    std::string_view name;
+    if (not reader.readName(name)) {
+        reader.unexpected("a string");
+        return std::string_view();
+    }
+
+    // without escapes the reader gives back the characters of the input
+    if (name.data() > this->start and name.data() < reader.position()) {
+        return name;
+    }
+    this->document->buffer.assign(name.data(), name.size());
+    return this->document->buffer;
+}
+
+JSONLazyValue::operator std::string() const {
+    std::string value;
+    if (this->start != nullptr) {
+        JSONReader(this->start).readString(value);
+    }
+    return value;
+}
+
+JSONLazyValue::operator bool() const {
+    return this->number<bool>();
+}
+
+JSONLazyValue::operator int() const {
+    return this->number<int>();
+}
+
+JSONLazyValue::operator long() const {
+    return this->number<long>();
+}
+
+JSONLazyValue::operator unsigned long() const {
+    return this->number<unsigned long>();
+}
+
+JSONLazyValue::operator long long() const {
+    return this->number<long long>();
+}
+
+JSONLazyValue::operator unsigned long long() const {
+    return this->number<unsigned long long>();
+}
+
+JSONLazyValue::operator float() const {
+    return this->number<float>();
+}
+
+JSONLazyValue::operator double() const {
+    return this->number<double>();
+}
+
+JSONLazyValue::operator long double() const {
+    return this->number<long double>();
+}
+
+JSON JSONLazyValue::toJSON() const {
+    if (this->start == nullptr) {
+        return JSON();
+    }
+    return JSONReader(this->start).readValue();
+}
+
+/// JSONLazyObject
+
+JSONLazyObject::JSONLazyObject(const char *start, JSONLazyDocument *document)
+    : reader(start != nullptr ? start : ""), start(start), document(document), pending(false), finished(false) {
+    // a missing value is an empty object, so chained lookups of missing keys stay quiet
+    this->finished = start == nullptr or not this->reader.startObject();
+}
+
+bool JSONLazyObject::next(std::string_view &key, JSONLazyValue &value) {
+    if (this->finished) {
+        return false;
+    }
+
+    if (this->pending) {
+        this->reader.skipValue();
+        this->pending = false;
+    }
+
+    if (not this->reader.nextKey(key)) {
+        this->finished = true;
+        return false;
+    }
+
+    value = JSONLazyValue(this->reader.position(), this->document);
+    this->pending = true;
+    return true;
+}
+
+JSONLazyValue JSONLazyObject::find(std::string_view key) {
+    if (this->pending) {
+        this->reader.skipValue();
+        this->pending = false;
+    }
+
+    // entries before origin are only looked at again after the end was reached
+    const char *origin = nullptr;
+    if (this->finished) {
+        this->restart();
+    } else {
+        origin = this->reader.position();
+    }
+    std::string_view candidate;
+    JSONLazyValue value;
+    while (this->next(candidate, value)) {
+        if (candidate == key) {
+            return value;
+        }
+    }
+
+    if (origin == nullptr or not this->reader.ok()) {
+        return JSONLazyValue();
+    }
+
+    this->restart();
+    while (this->next(candidate, value) and value.start < origin) {
+        if (candidate == key) {
+            return value;
+        }
+    }
+    return JSONLazyValue();
+}
+
+void JSONLazyObject::restart() {
+    this->reader = JSONReader(this->start != nullptr ? this->start : "");
+    this->pending = false;
+    this->finished = this->start == nullptr or not this->reader.startObject();
+}
+
+/// JSONLazyArray
+
+JSONLazyArray::JSONLazyArray(const char *start, JSONLazyDocument *document)
+    : reader(start != nullptr ? start : ""), document(document), pending(false), finished(false) {
+    this->finished = start == nullptr or not this->reader.startArray();
+}
+
+bool JSONLazyArray::next(JSONLazyValue &value) {
+    if (this->finished) {
+        return false;
+    }
+
+    if (this->pending) {
+        this->reader.skipValue();
+        this->pending = false;
+    }
+
+    if (not this->reader.nextElement()) {
+        this->finished = true;
+        return false;
+    }
+
+    value = JSONLazyValue(this->reader.position(), this->document);
+    this->pending = true;
+    return true;
+}
+
+}  // namespace autojson
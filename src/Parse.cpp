@@ -1,6 +1,11 @@
 #include "Parse.hpp"
 
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <locale>
+#include <sstream>
 
 namespace autojson {
 
@@ -55,8 +60,7 @@ std::string EscapeKeys(const std::string &content) {
     return result;
 }
 
-std::string ParseWord(const char *&content) {
-    std::string word = "";
+void SkipWord(const char *&content) {
     auto IsDelimiter = [&]() {
         for (char itr : "\n \t\r,:{}[]") {
             if (itr == *content) {
@@ -68,21 +72,128 @@ std::string ParseWord(const char *&content) {
     };
 
     while (!IsDelimiter()) {
-        word += *content;
         content++;
     }
+}
+
+namespace {
+
+// What SkipValue stops at. Every other character is passed over with one table lookup.
+enum SkipKind : unsigned char {
+    SKIP_PLAIN,
+    SKIP_QUOTE,
+    SKIP_OPEN,
+    SKIP_CLOSE,
+    SKIP_ESCAPE,
+    SKIP_END
+};
+
+struct SkipTable {
+    // outside of strings
+    unsigned char structure[256];
+    // inside of strings
+    unsigned char string[256];
+
+    constexpr SkipTable() : structure(), string() {
+        this->structure[(unsigned char)'\"'] = this->structure[(unsigned char)'\''] = SKIP_QUOTE;
+        this->structure[(unsigned char)'{'] = this->structure[(unsigned char)'['] = SKIP_OPEN;
+        this->structure[(unsigned char)'}'] = this->structure[(unsigned char)']'] = SKIP_CLOSE;
+        this->structure[0] = SKIP_END;
+        this->string[(unsigned char)'\"'] = this->string[(unsigned char)'\''] = SKIP_QUOTE;
+        this->string[(unsigned char)'\\'] = SKIP_ESCAPE;
+        this->string[0] = SKIP_END;
+    }
+};
 
-    return word;
+constexpr SkipTable kSkipTable;
+
+// content is on the opening quote. Either quote closes the string, like in ParseString.
+bool SkipString(const char *&content) {
+    const char *p = content + 1;
+    while (true) {
+        while (kSkipTable.string[(unsigned char)*p] == SKIP_PLAIN) {
+            p++;
+        }
+
+        unsigned char kind = kSkipTable.string[(unsigned char)*p];
+        if (kind == SKIP_QUOTE) {
+            content = p + 1;
+            return true;
+        }
+        if (kind == SKIP_END or p[1] == '\0') {
+            content = kind == SKIP_END ? p : p + 1;
+            return false;
+        }
+        p += 2;
+    }
 }
 
-std::string ParseString(const char *&content) {
+}  // namespace
+
+bool SkipValue(const char *&content) {
+    if (*content == '\"' or *content == '\'') {
+        return SkipString(content);
+    }
+
+    if (*content != '{' and *content != '[') {
+        const char *start = content;
+        SkipWord(content);
+        return content != start;
+    }
+
+    // only the nesting matters, strings are skipped so their brackets do not count
+    const char *p = content;
+    int depth = 0;
+    while (true) {
+        while (kSkipTable.structure[(unsigned char)*p] == SKIP_PLAIN) {
+            p++;
+        }
+
+        switch (kSkipTable.structure[(unsigned char)*p]) {
+            case SKIP_QUOTE:
+                if (not SkipString(p)) {
+                    content = p;
+                    return false;
+                }
+                break;
+            case SKIP_OPEN:
+                depth += 1;
+                p++;
+                break;
+            case SKIP_CLOSE:
+                depth -= 1;
+                p++;
+                if (depth == 0) {
+                    content = p;
+                    return true;
+                }
+                break;
+            default:
+                content = p;
+                return false;
+        }
+    }
+}
+
+std::string ParseWord(const char *&content) {
+    const char *start = content;
+    SkipWord(content);
+    return std::string(start, content);
+}
+
+void ParseString(const char *&content, std::string &txt) {
     if (*content == '\"' or *content == '\'') {
         content++;
     }
 
-    std::string txt = "";
+    txt.clear();
     bool escaped = false;
     while (not ((*content == '\"' or *content == '\'') and (escaped == false))) {
+        // unterminated, the caller finds the end of the input right after
+        if (*content == '\0') {
+            return;
+        }
+
         if (escaped) {
             if (*content != '\'' and *content != '\"') {
                 txt += '\\';
@@ -103,8 +214,204 @@ std::string ParseString(const char *&content) {
         content++;
     }
     content++;
+}
+
+void UnescapeString(const char *begin, const char *end, std::string &txt) {
+    txt.clear();
+    while (begin != end) {
+        const char *backslash = (const char*)memchr(begin, '\\', end - begin);
+        if (backslash == nullptr) {
+            txt.append(begin, end);
+            break;
+        }
 
+        txt.append(begin, backslash);
+        begin = backslash + 1;
+        if (begin == end) {
+            break;
+        }
+        if (*begin != '\'' and *begin != '\"') {
+            txt += '\\';
+        }
+        txt += *begin;
+        begin++;
+    }
+}
+
+std::string ParseString(const char *&content) {
+    std::string txt;
+    ParseString(content, txt);
     return txt;
 }
 
+namespace {
+
+bool IsDigit(char c) {
+    return '0' <= c and c <= '9';
+}
+
+// Every power of ten up to 1e22 is exactly representable as a double
+const double kExactPowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Correct for any input, but slow. Only used when the fast path can't guarantee
+// a correctly rounded result.
+double SlowParseReal(const char *begin, const char *end) {
+    std::istringstream in(std::string(begin, end));
+    in.imbue(std::locale::classic());
+    double value = 0;
+    in >> value;
+    if (in.fail() and std::fabs(value) == std::numeric_limits<double>::max()) {
+        // streams clamp out of range values instead of overflowing to infinity
+        value = std::copysign(HUGE_VAL, value);
+    }
+    return value;
+}
+
+}  // namespace
+
+bool ParseNumber(const char *begin, const char *end, JSON &result) {
+    const char *p = begin;
+    bool negative = false;
+    if (p != end and (*p == '-' or *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+
+    if (p == end or not IsDigit(*p)) {
+        return false;
+    }
+
+    // integer part; the value is kept only while it fits in 64 bits
+    unsigned long long integerPart = 0;
+    bool integerOverflow = false;
+    const char *integerBegin = p;
+    while (p != end and IsDigit(*p)) {
+        unsigned digit = *p - '0';
+        if (integerPart > (std::numeric_limits<unsigned long long>::max() - digit) / 10) {
+            integerOverflow = true;
+        }
+        integerPart = integerPart * 10 + digit;
+        p++;
+    }
+    const char *integerEnd = p;
+
+    const char *fractionBegin = p;
+    const char *fractionEnd = p;
+    if (p != end and *p == '.') {
+        p++;
+        fractionBegin = p;
+        while (p != end and IsDigit(*p)) {
+            p++;
+        }
+        fractionEnd = p;
+        if (fractionBegin == fractionEnd) {
+            return false;
+        }
+    }
+
+    bool hasExponent = false;
+    int exponent = 0;
+    if (p != end and (*p == 'e' or *p == 'E')) {
+        hasExponent = true;
+        p++;
+        bool negativeExponent = false;
+        if (p != end and (*p == '-' or *p == '+')) {
+            negativeExponent = (*p == '-');
+            p++;
+        }
+        if (p == end or not IsDigit(*p)) {
+            return false;
+        }
+        while (p != end and IsDigit(*p)) {
+            if (exponent < 100000) {
+                exponent = exponent * 10 + (*p - '0');
+            }
+            p++;
+        }
+        if (negativeExponent) {
+            exponent = -exponent;
+        }
+    }
+
+    if (p != end) {
+        return false;
+    }
+
+    bool isReal = hasExponent or fractionBegin != fractionEnd;
+    if (not isReal and not integerOverflow) {
+        const unsigned long long maxSigned = std::numeric_limits<long long>::max();
+        if (negative) {
+            if (integerPart <= maxSigned + 1) {
+                result = integerPart ? -(long long)(integerPart - 1) - 1 : 0LL;
+                return true;
+            }
+        } else if (integerPart <= maxSigned) {
+            result = (long long)integerPart;
+            return true;
+        } else {
+            result = integerPart;
+            return true;
+        }
+    }
+
+    // value = mantissa * 10^decimalExponent, with the mantissa holding every significant digit
+    unsigned long long mantissa = 0;
+    int significantDigits = 0;
+    int decimalExponent = exponent - int(fractionEnd - fractionBegin);
+    auto AddDigits = [&](const char *from, const char *to) {
+        for (; from != to; from++) {
+            if (significantDigits == 0 and *from == '0') {
+                continue;
+            }
+            significantDigits += 1;
+            if (significantDigits <= 19) {
+                mantissa = mantissa * 10 + (*from - '0');
+            }
+        }
+    };
+    AddDigits(integerBegin, integerEnd);
+    AddDigits(fractionBegin, fractionEnd);
+
+    double value;
+    if (significantDigits <= 19 and mantissa <= (1ULL << 53) and -22 <= decimalExponent and decimalExponent <= 22) {
+        // both operands are exact so the single rounding of * or / gives the correct result
+        value = double(mantissa);
+        if (decimalExponent < 0) {
+            value /= kExactPowersOfTen[-decimalExponent];
+        } else {
+            value *= kExactPowersOfTen[decimalExponent];
+        }
+        if (negative) {
+            value = -value;
+        }
+    } else {
+        value = SlowParseReal(begin, end);
+    }
+
+    result = value;
+    return true;
+}
+
+JSON ParsePrimitive(const char *word, size_t size) {
+    if (size == 4 and memcmp(word, "null", 4) == 0) {
+        return JSON(nullptr);
+    }
+    if (size == 4 and memcmp(word, "true", 4) == 0) {
+        return JSON(true);
+    }
+    if (size == 5 and memcmp(word, "false", 5) == 0) {
+        return JSON(false);
+    }
+
+    JSON number;
+    if (ParseNumber(word, word + size, number)) {
+        return number;
+    }
+
+    return JSON::rawPrimitive(word, size);
+}
+
 } // namespace autojson
@@ -3,8 +3,12 @@
 
 #include <string>
 
+#include "JSON.hpp"
+
 namespace autojson {
 
+class JSONHandler;
+
 void ParseError(const std::string &message, const char *content_pos);
 
 bool CanSkipWhitespace(const char *content, const std::string &custom_pass="");
@@ -13,10 +17,34 @@ void SkipWhitespace(const char *&content, const std::string &custom_pass);
 
 std::string EscapeKeys(const std::string &content);
 
+// Moves content past a bare word (number, literal) without copying it
+void SkipWord(const char *&content);
+
+// Moves content past the string, container or word it is on, without decoding it. Returns
+// false, with content on the '\0' or on the character it could not skip, when the input ends
+// or does not start a value.
+bool SkipValue(const char *&content);
+
 std::string ParseWord(const char *&content);
 
 std::string ParseString(const char *&content);
 
+// Same as above, but reuses the caller's buffer
+void ParseString(const char *&content, std::string &txt);
+
+// Unescapes the inside of a string the way ParseString does: only \" and \' lose their backslash
+void UnescapeString(const char *begin, const char *end, std::string &txt);
+
+// Turns a bare word into a typed primitive: null, true/false, a signed or unsigned
+// integer, or a real. Words that are none of those are kept as RAW text.
+JSON ParsePrimitive(const char *word, size_t size);
+
+// Reports a bare word to handler as null, a boolean, a number or RAW text. Defined with ParseEvents.
+bool EmitWord(const char *word, size_t size, JSONHandler &handler);
+
+// Locale independent JSON number parser. Returns false if [begin, end) is not a number.
+bool ParseNumber(const char *begin, const char *end, JSON &result);
+
 } // namespace autojson
 
 #ifndef autojsonuselib
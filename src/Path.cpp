@@ -0,0 +1,101 @@
+#include "Path.hpp"
+
+#include "Error.hpp"
+
+namespace autojson {
+
+JSONPath::JSONPath(std::string_view pointer) : ok(true) {
+    if (pointer.empty()) {
+        return;
+    }
+    if (pointer[0] != '/') {
+        JSONError("JSON Pointer must start with '/': " + std::string(pointer));
+        this->ok = false;
+        return;
+    }
+
+    // ~1 stands for '/' and ~0 for '~', in that order
+    std::string token;
+    for (size_t i = 1; i <= pointer.size(); i += 1) {
+        if (i == pointer.size() or pointer[i] == '/') {
+            this->addToken(token);
+            token.clear();
+        } else if (pointer[i] != '~') {
+            token += pointer[i];
+        } else if (i + 1 < pointer.size() and (pointer[i + 1] == '0' or pointer[i + 1] == '1')) {
+            token += pointer[i + 1] == '0' ? '~' : '/';
+            i += 1;
+        } else {
+            JSONError("Bad escape in JSON Pointer: " + std::string(pointer));
+            this->steps.clear();
+            this->ok = false;
+            return;
+        }
+    }
+}
+
+JSONPath& JSONPath::key(std::string_view key) {
+    this->addToken(key);
+    return *this;
+}
+
+JSONPath& JSONPath::index(size_t index) {
+    this->steps.push_back(Step{JSON::Key(std::to_string(index)), index});
+    return *this;
+}
+
+std::string JSONPath::pointer() const {
+    std::string result;
+    for (const Step &step : this->steps) {
+        result += '/';
+        for (char c : std::string_view(step.key)) {
+            if (c == '~') {
+                result += "~0";
+            } else if (c == '/') {
+                result += "~1";
+            } else {
+                result += c;
+            }
+        }
+    }
+    return result;
+}
+
+const JSON* JSONPath::find(const JSON &root) const {
+    if (not this->ok) {
+        return nullptr;
+    }
+
+    const JSON *current = &root;
+    for (const Step &step : this->steps) {
+        if (current->type == JSONType::OBJECT) {
+            current = current->find(step.key);
+            if (current == nullptr) {
+                return nullptr;
+            }
+        } else if (current->type == JSONType::VECTOR and step.index < (size_t)current->size()) {
+            current = &current->begin()[step.index];
+        } else {
+            return nullptr;
+        }
+    }
+    return current;
+}
+
+void JSONPath::addToken(std::string_view token) {
+    // digits without a leading zero, as RFC 6901 writes array indices
+    size_t index = kNoIndex;
+    if (not token.empty() and token.size() < 19 and (token[0] != '0' or token.size() == 1)) {
+        index = 0;
+        for (char c : token) {
+            if (c < '0' or c > '9') {
+                index = kNoIndex;
+                break;
+            }
+            index = index * 10 + (c - '0');
+        }
+    }
+    this->steps.push_back(Step{JSON::Key(token), index});
+}
+
+}  // namespace autojson
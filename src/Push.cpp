@@ -0,0 +1,364 @@
+#include "Push.hpp"
+
+#include <iostream>
+
+#include "Builder.hpp"
+#include "Instrument.hpp"
+#include "Parse.hpp"
+
+namespace autojson {
+
+// Builds the tree of a JSONPushParser out of its events, on the stacks of a JSONBuilder, so
+// every container gets exactly the size it needs
+class PushTree : public JSONHandler {
+public:
+    bool startObject() override {
+        this->starts.emplace_back(this->builder.stackSize(), this->builder.keyCount());
+        return true;
+    }
+
+    bool key(const char *data, size_t size) override {
+        this->builder.pushKey(data, size);
+        return true;
+    }
+
+    bool endObject() override {
+        auto start = this->starts.back();
+        this->starts.pop_back();
+        this->builder.push(this->builder.makeObject(start.first, start.second));
+        return true;
+    }
+
+    bool startArray() override {
+        this->starts.emplace_back(this->builder.stackSize(), this->builder.keyCount());
+        return true;
+    }
+
+    bool endArray() override {
+        size_t first = this->starts.back().first;
+        this->starts.pop_back();
+        this->builder.push(this->builder.makeVector(first));
+        return true;
+    }
+
+    bool string(const char *data, size_t size) override {
+        this->builder.push(this->builder.makeString(data, size));
+        return true;
+    }
+
+    bool null() override {
+        this->builder.push(JSON(nullptr));
+        return true;
+    }
+
+    bool boolean(bool value) override {
+        this->builder.push(JSON(value));
+        return true;
+    }
+
+    bool integer(long long value) override {
+        this->builder.push(JSON(value));
+        return true;
+    }
+
+    bool unsignedInteger(unsigned long long value) override {
+        this->builder.push(JSON(value));
+        return true;
+    }
+
+    bool real(double value) override {
+        this->builder.push(JSON(value));
+        return true;
+    }
+
+    bool raw(const char *data, size_t size) override {
+        this->builder.push(this->builder.makePrimitive(data, size));
+        return true;
+    }
+
+    // The root, once; invalid after that
+    JSON take() {
+        if (this->builder.stackSize() == 0) {
+            return JSON();
+        }
+        JSON result = this->builder.pop();
+        this->clear();
+        return result;
+    }
+
+    void clear() {
+        this->builder.clear();
+        this->starts.clear();
+    }
+
+private:
+    JSONBuilder builder;
+    // stack size and key count when each open container started
+    std::vector<std::pair<size_t, size_t>> starts;
+};
+
+JSONPushParser::JSONPushParser() : tree(new PushTree), handler(tree.get()) {
+    this->reset();
+}
+
+JSONPushParser::JSONPushParser(JSONHandler &handler) : handler(&handler) {
+    this->reset();
+}
+
+JSONPushParser::~JSONPushParser() {
+}
+
+bool JSONPushParser::feed(const char *data, size_t size) {
+    // each piece is timed on its own, the time between pieces is spent waiting for them
+    AUTOJSON_TIME(PARSE_TIME);
+    AUTOJSON_COUNT(BYTES_PARSED, size);
+    const char *p = data;
+    const char *end = data + size;
+
+    while (p != end) {
+        char c = *p;
+        switch (this->state) {
+            case BEFORE_VALUE:
+                if (c == ' ' or c == '\t' or c == '\n' or c == '\r' or c == ',') {
+                    p++;
+                } else if (c == '{') {
+                    p++;
+                    this->containers.push_back('{');
+                    this->state = BEFORE_KEY;
+                    if (not this->handler->startObject()) {
+                        return this->stop();
+                    }
+                } else if (c == '[') {
+                    p++;
+                    this->containers.push_back('[');
+                    if (not this->handler->startArray()) {
+                        return this->stop();
+                    }
+                } else if (c == ']' and not this->containers.empty() and this->containers.back() == '[') {
+                    p++;
+                    this->containers.pop_back();
+                    this->endValue();
+                    if (not this->handler->endArray()) {
+                        return this->stop();
+                    }
+                } else if (c == '\"' or c == '\'') {
+                    p++;
+                    this->state = IN_STRING;
+                    this->inKey = false;
+                } else if (c == '}' or c == ']' or c == ':') {
+                    return this->fail("Unexpected character", this->offset + (p - data));
+                } else {
+                    this->state = IN_WORD;
+                }
+                break;
+            case BEFORE_KEY:
+                if (c == ' ' or c == '\t' or c == '\n' or c == '\r' or c == ',') {
+                    p++;
+                } else if (c == '}') {
+                    p++;
+                    this->containers.pop_back();
+                    this->endValue();
+                    if (not this->handler->endObject()) {
+                        return this->stop();
+                    }
+                } else if (c == '\"' or c == '\'') {
+                    p++;
+                    this->state = IN_STRING;
+                    this->inKey = true;
+                } else {
+                    return this->fail("Expected a key. Got something else", this->offset + (p - data));
+                }
+                break;
+            case BEFORE_COLON:
+                if (c == ' ' or c == '\t' or c == '\n' or c == '\r') {
+                    p++;
+                } else if (c == ':') {
+                    p++;
+                    this->state = BEFORE_VALUE;
+                } else {
+                    return this->fail("Expected ':'. Got something else", this->offset + (p - data));
+                }
+                break;
+            case IN_STRING:
+                p = this->readString(p, end);
+                break;
+            case IN_WORD:
+                p = this->readWord(p, end);
+                break;
+            case DONE:
+                // like JSON::parse, what follows the document may only be separators
+                if (c != ' ' and c != '\t' and c != '\n' and c != '\r' and c != ',') {
+                    return this->fail("Unexpected character after the end of the document", this->offset + (p - data));
+                }
+                p++;
+                break;
+            case FAILED:
+                return false;
+        }
+    }
+
+    this->offset += size;
+    return this->state != FAILED;
+}
+
+bool JSONPushParser::feed(const std::string &data) {
+    return this->feed(data.data(), data.size());
+}
+
+bool JSONPushParser::finish() {
+    if (this->state == IN_WORD) {
+        // nothing after the word, so all of it was fed before
+        bool ok = EmitWord(this->buffer.data(), this->buffer.size(), *this->handler);
+        this->pending = false;
+        this->buffer.clear();
+        if (not ok) {
+            return this->stop();
+        }
+        this->endValue();
+    }
+
+    if (this->state == FAILED) {
+        return false;
+    }
+    if (this->state != DONE) {
+        return this->fail("Unexpected EOF", this->offset);
+    }
+    return true;
+}
+
+JSON JSONPushParser::result() {
+    if (this->state != DONE or this->tree == nullptr) {
+        return JSON();
+    }
+    return this->tree->take();
+}
+
+void JSONPushParser::reset() {
+    if (this->tree != nullptr) {
+        this->tree->clear();
+    }
+    this->state = BEFORE_VALUE;
+    this->containers.clear();
+    this->inKey = false;
+    this->escaped = false;
+    this->pending = false;
+    this->buffer.clear();
+    this->offset = 0;
+}
+
+const char* JSONPushParser::readString(const char *p, const char *end) {
+    // same unescaping as ParseString: only \" and \' lose their backslash, and either quote
+    // closes the string
+    const char *segment = p;
+    while (p != end) {
+        if (this->escaped) {
+            if (*p != '\"' and *p != '\'') {
+                this->buffer += '\\';
+            }
+            this->buffer += *p;
+            p++;
+            segment = p;
+            this->escaped = false;
+            continue;
+        }
+
+        while (p != end and *p != '\"' and *p != '\'' and *p != '\\') {
+            p++;
+        }
+        if (p == end) {
+            break;
+        }
+
+        if (*p == '\\') {
+            this->buffer.append(segment, p);
+            this->pending = true;
+            this->escaped = true;
+            p++;
+            segment = p;
+            continue;
+        }
+
+        // closing quote; a string that was never cut is sent from where it is
+        const char *text = segment;
+        size_t size = p - segment;
+        if (this->pending) {
+            this->buffer.append(segment, p);
+            text = this->buffer.data();
+            size = this->buffer.size();
+        }
+        p++;
+
+        bool ok;
+        if (this->inKey) {
+            this->state = BEFORE_COLON;
+            ok = this->handler->key(text, size);
+        } else {
+            this->endValue();
+            ok = this->handler->string(text, size);
+        }
+        this->pending = false;
+        this->buffer.clear();
+        if (not ok) {
+            this->stop();
+        }
+        return p;
+    }
+
+    this->buffer.append(segment, p);
+    this->pending = true;
+    return p;
+}
+
+const char* JSONPushParser::readWord(const char *p, const char *end) {
+    // ends where SkipWord ends it
+    const char *segment = p;
+    while (p != end and *p != ' ' and *p != '\t' and *p != '\n' and *p != '\r' and *p != ',' and
+           *p != ':' and *p != '{' and *p != '}' and *p != '[' and *p != ']') {
+        p++;
+    }
+
+    if (p == end) {
+        this->buffer.append(segment, p);
+        this->pending = true;
+        return p;
+    }
+
+    const char *word = segment;
+    size_t size = p - segment;
+    if (this->pending) {
+        this->buffer.append(segment, p);
+        word = this->buffer.data();
+        size = this->buffer.size();
+    }
+
+    // the delimiter is read by the next state
+    this->endValue();
+    bool ok = EmitWord(word, size, *this->handler);
+    this->pending = false;
+    this->buffer.clear();
+    if (not ok) {
+        this->stop();
+    }
+    return p;
+}
+
+void JSONPushParser::endValue() {
+    if (this->containers.empty()) {
+        this->state = DONE;
+    } else {
+        this->state = this->containers.back() == '{' ? BEFORE_KEY : BEFORE_VALUE;
+    }
+}
+
+bool JSONPushParser::fail(const char *message, size_t position) {
+    std::cerr << "[ERROR]\t" << message << " at byte " << position << '\n';
+    this->state = FAILED;
+    return false;
+}
+
+bool JSONPushParser::stop() {
+    this->state = FAILED;
+    return false;
+}
+
+}  // namespace autojson
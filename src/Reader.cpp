@@ -0,0 +1,280 @@
+#include "Reader.hpp"
+
+#include <cctype>
+#include <cstring>
+
+#include "Builder.hpp"
+#include "Parse.hpp"
+
+namespace autojson {
+
+bool JSONReader::startObject() {
+    return this->startContainer('{', "an object");
+}
+
+bool JSONReader::nextKey(std::string_view &key) {
+    if (this->failed) {
+        return false;
+    }
+
+    this->skipSeparators();
+    if (*this->content == '}') {
+        this->content++;
+        return false;
+    }
+
+    if (*this->content != '\"' and *this->content != '\'') {
+        this->fail("Expected a key. Got something else");
+        return false;
+    }
+
+    const char *data;
+    size_t size;
+    if (not this->readRawString(data, size)) {
+        return false;
+    }
+
+    // get to :
+    while (*this->content == ' ' or *this->content == '\t' or *this->content == '\n' or *this->content == '\r') {
+        this->content++;
+    }
+    if (*this->content != ':') {
+        this->fail("Expected ':'. Got something else");
+        return false;
+    }
+
+    this->content++;
+    key = std::string_view(data, size);
+    return true;
+}
+
+bool JSONReader::startArray() {
+    return this->startContainer('[', "an array");
+}
+
+bool JSONReader::nextElement() {
+    if (this->failed) {
+        return false;
+    }
+
+    this->skipSeparators();
+    if (*this->content == ']') {
+        this->content++;
+        return false;
+    }
+
+    if (*this->content == '\0') {
+        this->fail("Unexpected EOF");
+        return false;
+    }
+
+    return true;
+}
+
+void JSONReader::skipValue() {
+    if (this->failed) {
+        return;
+    }
+
+    this->skipSeparators();
+    if (not SkipValue(this->content)) {
+        this->fail(*this->content == '\0' ? "Unexpected EOF" : "Unexpected character");
+    }
+}
+
+JSON JSONReader::readScalar() {
+    if (this->failed) {
+        return JSON();
+    }
+
+    this->skipSeparators();
+    char c = *this->content;
+    if (c == '\"' or c == '\'') {
+        const char *data;
+        size_t size;
+        if (not this->readRawString(data, size)) {
+            return JSON();
+        }
+        return JSON(data, size);
+    }
+
+    if (c == '{' or c == '[') {
+        this->unexpected("a single value");
+        return JSON();
+    }
+
+    if (c == '\0') {
+        this->fail("Unexpected EOF");
+        return JSON();
+    }
+
+    const char *start = this->content;
+    SkipWord(this->content);
+    if (this->content == start) {
+        this->fail("Unexpected character");
+        return JSON();
+    }
+    return ParsePrimitive(start, this->content - start);
+}
+
+void JSONReader::readString(std::string &value) {
+    if (this->failed) {
+        return;
+    }
+
+    this->skipSeparators();
+    char c = *this->content;
+    if (c == '\"' or c == '\'') {
+        const char *data;
+        size_t size;
+        if (this->readRawString(data, size)) {
+            value.assign(data, size);
+        }
+    } else if (c == '{' or c == '[') {
+        value = this->readValue().stringify();
+    } else {
+        JSON scalar = this->readScalar();
+        if (scalar.valid()) {
+            value = (std::string)scalar;
+        }
+    }
+}
+
+bool JSONReader::readName(std::string_view &name) {
+    if (this->failed) {
+        return false;
+    }
+
+    this->skipSeparators();
+    if (*this->content != '\"' and *this->content != '\'') {
+        return false;
+    }
+
+    const char *data;
+    size_t size;
+    if (not this->readRawString(data, size)) {
+        return false;
+    }
+    name = std::string_view(data, size);
+    return true;
+}
+
+bool JSONReader::readNull() {
+    if (this->failed) {
+        return false;
+    }
+
+    this->skipSeparators();
+    if (strncmp(this->content, "null", 4) != 0) {
+        return false;
+    }
+
+    const char *start = this->content;
+    SkipWord(this->content);
+    if (this->content - start == 4) {
+        return true;
+    }
+    this->content = start;
+    return false;
+}
+
+JSON JSONReader::readValue() {
+    if (this->failed) {
+        return JSON();
+    }
+
+    // the bounded parser, on exactly the bytes of the value: the input may not be trusted
+    this->skipSeparators();
+    const char *start = this->content;
+    if (not SkipValue(this->content)) {
+        this->fail(*this->content == '\0' ? "Unexpected EOF" : "Unexpected character");
+        return JSON();
+    }
+
+    ParseResult result;
+    JSONBuilder builder;
+    JSON value = builder.parseBounded(start, this->content - start, result);
+    if (not result.ok()) {
+        // capitalized like the other messages of the reader
+        std::string message = result.message();
+        message[0] = (char)toupper((unsigned char)message[0]);
+        this->content = start + result.offset;
+        this->fail(message.c_str());
+        return JSON();
+    }
+    return value;
+}
+
+void JSONReader::skipSeparators() {
+    while (*this->content == ' ' or *this->content == '\t' or *this->content == '\n' or *this->content == '\r' or
+           *this->content == ',') {
+        this->content++;
+    }
+}
+
+bool JSONReader::startContainer(char open, const char *name) {
+    if (this->failed) {
+        return false;
+    }
+
+    this->skipSeparators();
+    if (*this->content == open) {
+        this->content++;
+        return true;
+    }
+
+    if (*this->content == '\0') {
+        this->fail("Unexpected EOF");
+        return false;
+    }
+
+    if (this->readNull()) {
+        return false;
+    }
+
+    this->unexpected(name);
+    return false;
+}
+
+bool JSONReader::readRawString(const char *&data, size_t &size) {
+    // either quote closes the string, whichever one opened it
+    const char *begin = this->content + 1;
+    const char *end = begin;
+    bool hasEscapes = false;
+    while (*end != '\"' and *end != '\'') {
+        if (*end == '\0') {
+            this->fail("Unexpected EOF");
+            return false;
+        }
+        if (*end == '\\') {
+            hasEscapes = true;
+            end++;
+            if (*end == '\0') {
+                continue;
+            }
+        }
+        end++;
+    }
+
+    this->content = end + 1;
+    if (hasEscapes) {
+        UnescapeString(begin, end, this->buffer);
+        data = this->buffer.data();
+        size = this->buffer.size();
+    } else {
+        data = begin;
+        size = end - begin;
+    }
+    return true;
+}
+
+void JSONReader::unexpected(const char *expected) {
+    this->fail((std::string("Expected ") + expected + ". Got something else").c_str());
+}
+
+void JSONReader::fail(const char *message) {
+    ParseError(message, this->content);
+    this->failed = true;
+}
+
+}  // namespace autojson
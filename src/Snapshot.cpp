@@ -0,0 +1,738 @@
+#include "Snapshot.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+#include "Error.hpp"
+#include "Object.hpp"
+
+namespace autojson {
+
+// Every part of a snapshot starts at a multiple of 8 bytes from its beginning. Offsets are
+// counted from there too, so the snapshot does not depend on where it is mapped.
+struct SnapshotNode {
+    JSONType type;
+    JSONPrimitiveType primitive;
+    uint16_t reserved;
+    // bytes of a text, entries of a container
+    uint32_t size;
+    // booleans are stored as integers 0 and 1
+    union {
+        long long integer;
+        unsigned long long unsignedInteger;
+        double real;
+        // of the text or of the first entry
+        unsigned long long offset;
+    };
+};
+
+// Objects keep their entries in order. Above JSONObject::kLinearScanLimit entries they are
+// followed by an open-addressing index like the one of JSONObject, so lookups stay O(1).
+struct SnapshotEntry {
+    unsigned long long keyOffset;
+    uint32_t keySize;
+    // HashKey(key), so the index does not depend on the hash of the process that reads it
+    uint32_t hash;
+    SnapshotNode value;
+};
+
+struct SnapshotSlot {
+    // position + 1 of an entry, 0 for an empty slot
+    uint32_t position;
+    uint32_t hash;
+};
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    // kByteOrderMark as the writer stored it
+    uint32_t byteOrder;
+    unsigned long long size;
+    SnapshotNode root;
+};
+
+namespace {
+
+const char kSnapshotMagic[8] = {'a', 'u', 't', 'o', 'j', 's', 'o', 'n'};
+
+// Changes whenever the layout, or HashKey, does
+const uint32_t kSnapshotVersion = 1;
+
+const uint32_t kByteOrderMark = 0x01020304;
+
+// Slots of the index of an object with size entries: a load factor under 1/2, as in JSONObject
+size_t IndexCapacity(size_t size) {
+    size_t capacity = 1;
+    while (capacity < 2 * size) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+}  // namespace
+
+// Lays out a JSON tree as a snapshot. Space is reserved for all the nodes of a container
+// before any of them is written, so the children of a container are next to each other.
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(std::string &output) : out(output), start(output.size()) { }
+
+    void write(const JSON &value);
+
+private:
+    std::string &out;
+    size_t start;
+    // keys repeat across objects, so each one is stored once
+    std::unordered_map<std::string_view, unsigned long long> keys;
+
+    // Offset of size zeroed bytes added at the end
+    unsigned long long allocate(size_t size);
+
+    unsigned long long text(const char *data, size_t size);
+
+    // Writes value into the node at offset
+    void node(const JSON &value, unsigned long long offset);
+
+    template<typename T>
+    T* at(unsigned long long offset) {
+        return (T*)&this->out[this->start + offset];
+    }
+};
+
+void SnapshotWriter::write(const JSON &value) {
+    unsigned long long header = this->allocate(sizeof(SnapshotHeader));
+    this->node(value, header + offsetof(SnapshotHeader, root));
+
+    SnapshotHeader *h = this->at<SnapshotHeader>(header);
+    memcpy(h->magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+    h->version = kSnapshotVersion;
+    h->byteOrder = kByteOrderMark;
+    h->size = this->out.size() - this->start;
+}
+
+unsigned long long SnapshotWriter::allocate(size_t size) {
+    size_t end = this->out.size() - this->start;
+    size_t offset = (end + 7) & ~(size_t)7;
+    this->out.resize(this->start + offset + size, '\0');
+    return offset;
+}
+
+unsigned long long SnapshotWriter::text(const char *data, size_t size) {
+    // with a '\0' after it, like std::string
+    unsigned long long offset = this->allocate(size + 1);
+    memcpy(this->at<char>(offset), data, size);
+    return offset;
+}
+
+void SnapshotWriter::node(const JSON &value, unsigned long long offset) {
+    SnapshotNode node;
+    memset(&node, 0, sizeof(node));
+    node.type = value.type;
+    node.primitive = value.primitiveType();
+
+    switch (value.type) {
+        case JSONType::PRIMITIVE:
+            switch (value.primitiveType()) {
+                case JSONPrimitiveType::NULL_VALUE:
+                    break;
+                case JSONPrimitiveType::BOOLEAN:
+                    node.integer = value.boolean;
+                    break;
+                case JSONPrimitiveType::INTEGER:
+                    node.integer = value.integer;
+                    break;
+                case JSONPrimitiveType::UNSIGNED:
+                    node.unsignedInteger = value.unsignedInteger;
+                    break;
+                case JSONPrimitiveType::REAL:
+                    node.real = value.real;
+                    break;
+                default:
+                    node.size = value.textSize();
+                    node.offset = this->text(value.textData(), value.textSize());
+            }
+            break;
+        case JSONType::STRING:
+            if (value.textSize() > UINT32_MAX) {
+                JSONError("Cannot snapshot a string longer than 4GB");
+                node.type = JSONType::INVALID;
+                break;
+            }
+            node.size = value.textSize();
+            node.offset = this->text(value.textData(), value.textSize());
+            break;
+        case JSONType::VECTOR: {
+            const JSON::Vector &vector = *value.vector;
+            node.size = vector.size();
+            node.offset = this->allocate(vector.size() * sizeof(SnapshotNode));
+            for (size_t i = 0; i < vector.size(); i += 1) {
+                this->node(vector[i], node.offset + i * sizeof(SnapshotNode));
+            }
+            break;
+        }
+        case JSONType::OBJECT: {
+            const JSON::Object &object = *value.object;
+            node.size = object.size();
+            node.offset = this->allocate(object.size() * sizeof(SnapshotEntry));
+
+            // right after the entries, which take a multiple of 8 bytes
+            if (object.size() > JSONObject::kLinearScanLimit) {
+                size_t capacity = IndexCapacity(object.size());
+                unsigned long long index = this->allocate(capacity * sizeof(SnapshotSlot));
+                size_t position = 0;
+                for (const auto &itr : object) {
+                    size_t i = itr.hash & (capacity - 1);
+                    while (this->at<SnapshotSlot>(index)[i].position != 0) {
+                        i = (i + 1) & (capacity - 1);
+                    }
+                    this->at<SnapshotSlot>(index)[i] = SnapshotSlot{(uint32_t)position + 1, itr.hash};
+                    position += 1;
+                }
+            }
+
+            unsigned long long entry = node.offset;
+            for (const auto &itr : object) {
+                auto key = this->keys.find(itr.key());
+                unsigned long long keyOffset;
+                if (key != this->keys.end()) {
+                    keyOffset = key->second;
+                } else {
+                    keyOffset = this->text(itr.keyData, itr.keySize);
+                    this->keys.emplace(itr.key(), keyOffset);
+                }
+
+                SnapshotEntry *e = this->at<SnapshotEntry>(entry);
+                e->keyOffset = keyOffset;
+                e->keySize = itr.keySize;
+                e->hash = itr.hash;
+                this->node(itr.value, entry + offsetof(SnapshotEntry, value));
+                entry += sizeof(SnapshotEntry);
+            }
+            break;
+        }
+        default:
+            JSONError("Cannot snapshot an invalid JSON");
+    }
+
+    memcpy(this->at<SnapshotNode>(offset), &node, sizeof(node));
+}
+
+/// JSONView
+
+JSONView JSONView::iterator::operator*() const {
+    // the node is the end of an element and of an entry alike
+    return JSONView(this->base, this->limit, (const SnapshotNode*)(this->position + this->stride - sizeof(SnapshotNode)));
+}
+
+std::string_view JSONView::iterator::key() const {
+    if (this->stride != sizeof(SnapshotEntry)) {
+        JSONError("Only the entries of an object have a key");
+        return std::string_view("", 0);
+    }
+
+    const SnapshotEntry *entry = (const SnapshotEntry*)this->position;
+    JSONView view(this->base, this->limit, nullptr);
+    const char *key = view.at(entry->keyOffset, entry->keySize);
+    return key != nullptr ? std::string_view(key, entry->keySize) : std::string_view("", 0);
+}
+
+JSONType JSONView::type() const {
+    return this->node != nullptr ? this->node->type : JSONType::INVALID;
+}
+
+JSONPrimitiveType JSONView::primitiveType() const {
+    return this->node != nullptr ? this->node->primitive : JSONPrimitiveType::RAW;
+}
+
+bool JSONView::isNull() const {
+    return this->type() == JSONType::PRIMITIVE and this->node->primitive == JSONPrimitiveType::NULL_VALUE;
+}
+
+bool JSONView::isInteger() const {
+    return this->type() == JSONType::PRIMITIVE and
+            (this->node->primitive == JSONPrimitiveType::INTEGER or this->node->primitive == JSONPrimitiveType::UNSIGNED);
+}
+
+bool JSONView::isReal() const {
+    return this->isInteger() or (this->type() == JSONType::PRIMITIVE and this->node->primitive == JSONPrimitiveType::REAL);
+}
+
+bool JSONView::isBool() const {
+    return this->type() == JSONType::PRIMITIVE and this->node->primitive == JSONPrimitiveType::BOOLEAN;
+}
+
+bool JSONView::isString() const {
+    return this->type() == JSONType::STRING;
+}
+
+bool JSONView::isArray() const {
+    return this->type() == JSONType::VECTOR;
+}
+
+bool JSONView::isObject() const {
+    return this->type() == JSONType::OBJECT;
+}
+
+int JSONView::size() const {
+    if (this->type() != JSONType::OBJECT) {
+        this->checkType(JSONType::VECTOR);
+    }
+    return this->node != nullptr ? this->node->size : 0;
+}
+
+JSONView JSONView::operator[](int index) const {
+    JSONType type = this->type();
+    if (type != JSONType::OBJECT) {
+        this->checkType(JSONType::VECTOR);
+        if (type != JSONType::VECTOR) {
+            return JSONView();
+        }
+    }
+
+    if (index < 0 or (uint32_t)index >= this->node->size) {
+        JSONError("Vector out of bounds " + std::to_string(index) + ":" + std::to_string(this->node->size));
+        return JSONView();
+    }
+
+    size_t stride = type == JSONType::VECTOR ? sizeof(SnapshotNode) : sizeof(SnapshotEntry);
+    const char *entries = this->children((index + 1) * stride);
+    if (entries == nullptr) {
+        return JSONView();
+    }
+    return JSONView(this->base, this->limit, (const SnapshotNode*)(entries + (index + 1) * stride - sizeof(SnapshotNode)));
+}
+
+JSONView JSONView::operator[](std::string_view key) const {
+    // like the const lookups of JSON: anything but an object has no keys, so chains through
+    // missing values end invalid instead of failing
+    return JSONView(this->base, this->limit, this->find(key));
+}
+
+JSONView JSONView::operator[](const std::string &key) const {
+    return (*this)[std::string_view(key)];
+}
+
+JSONView JSONView::operator[](const char *key) const {
+    return (*this)[std::string_view(key)];
+}
+
+bool JSONView::exists(std::string_view key) const {
+    return this->find(key) != nullptr;
+}
+
+std::string_view JSONView::key(int index) const {
+    this->checkType(JSONType::OBJECT);
+    if (this->type() != JSONType::OBJECT) {
+        return std::string_view("", 0);
+    }
+    if (index < 0 or (uint32_t)index >= this->node->size) {
+        JSONError("Object out of bounds " + std::to_string(index) + ":" + std::to_string(this->node->size));
+        return std::string_view("", 0);
+    }
+
+    const char *entries = this->children((index + 1) * sizeof(SnapshotEntry));
+    if (entries == nullptr) {
+        return std::string_view("", 0);
+    }
+    const SnapshotEntry *e = (const SnapshotEntry*)entries + index;
+    const char *key = this->at(e->keyOffset, e->keySize);
+    return key != nullptr ? std::string_view(key, e->keySize) : std::string_view("", 0);
+}
+
+JSONView::iterator JSONView::begin() const {
+    JSONType type = this->type();
+    if (type != JSONType::OBJECT) {
+        this->checkType(JSONType::VECTOR);
+    }
+
+    size_t stride = type == JSONType::OBJECT ? sizeof(SnapshotEntry) : sizeof(SnapshotNode);
+    const char *entries = nullptr;
+    if (type == JSONType::VECTOR or type == JSONType::OBJECT) {
+        entries = this->children(this->node->size * stride);
+    }
+    return iterator(this->base, this->limit, entries, stride);
+}
+
+JSONView::iterator JSONView::end() const {
+    iterator itr = this->begin();
+    if (itr.position != nullptr) {
+        itr.position += this->node->size * itr.stride;
+    }
+    return itr;
+}
+
+std::string_view JSONView::text() const {
+    JSONType type = this->type();
+    if (type != JSONType::STRING and not (type == JSONType::PRIMITIVE and this->node->primitive == JSONPrimitiveType::RAW)) {
+        this->checkType(JSONType::STRING);
+        return std::string_view("", 0);
+    }
+
+    const char *text = this->at(this->node->offset, this->node->size);
+    return text != nullptr ? std::string_view(text, this->node->size) : std::string_view("", 0);
+}
+
+JSONView::operator bool() const {
+    JSONType type = this->type();
+    if (type == JSONType::PRIMITIVE) {
+        switch (this->node->primitive) {
+            case JSONPrimitiveType::NULL_VALUE:
+                return false;
+            case JSONPrimitiveType::BOOLEAN:
+                return this->node->integer != 0;
+            case JSONPrimitiveType::INTEGER:
+                return this->node->integer == 1;
+            case JSONPrimitiveType::UNSIGNED:
+                return this->node->unsignedInteger == 1;
+            case JSONPrimitiveType::REAL:
+                return this->node->real == 1;
+            default:
+                std::string_view txt = this->text();
+                return txt == "true" || txt == "1";
+        }
+    } else if (type == JSONType::INVALID) {
+        return false;
+    } else {
+        this->checkType(JSONType::PRIMITIVE);
+        return false;
+    }
+}
+
+template<typename T>
+T JSONView::toNumber() const {
+    this->checkType(JSONType::PRIMITIVE);
+    if (this->type() != JSONType::PRIMITIVE) {
+        return T(0);
+    }
+
+    switch (this->node->primitive) {
+        case JSONPrimitiveType::NULL_VALUE:
+            return T(0);
+        case JSONPrimitiveType::BOOLEAN:
+            return T(this->node->integer != 0);
+        case JSONPrimitiveType::INTEGER:
+            return T(this->node->integer);
+        case JSONPrimitiveType::UNSIGNED:
+            return T(this->node->unsignedInteger);
+        case JSONPrimitiveType::REAL:
+            return T(this->node->real);
+        default:
+            break;
+    }
+
+    std::string txt(this->text());
+    if (std::is_floating_point<T>::value) {
+        return T(std::stold(txt));
+    } else if (std::is_signed<T>::value) {
+        return T(std::stoll(txt));
+    } else {
+        return T(std::stoull(txt));
+    }
+}
+
+JSONView::operator int() const {
+    return this->toNumber<int>();
+}
+
+JSONView::operator long() const {
+    return this->toNumber<long>();
+}
+
+JSONView::operator unsigned long() const {
+    return this->toNumber<unsigned long>();
+}
+
+JSONView::operator long long() const {
+    return this->toNumber<long long>();
+}
+
+JSONView::operator unsigned long long() const {
+    return this->toNumber<unsigned long long>();
+}
+
+JSONView::operator float() const {
+    return this->toNumber<float>();
+}
+
+JSONView::operator double() const {
+    return this->toNumber<double>();
+}
+
+JSONView::operator long double() const {
+    return this->toNumber<long double>();
+}
+
+JSONView::operator std::string() const {
+    if (this->type() == JSONType::STRING) {
+        return std::string(this->text());
+    } else {
+        return this->toJSON().stringify();
+    }
+}
+
+JSON JSONView::toJSON() const {
+    switch (this->type()) {
+        case JSONType::PRIMITIVE:
+            switch (this->node->primitive) {
+                case JSONPrimitiveType::NULL_VALUE:
+                    return JSON(nullptr);
+                case JSONPrimitiveType::BOOLEAN:
+                    return JSON(this->node->integer != 0);
+                case JSONPrimitiveType::INTEGER:
+                    return JSON(this->node->integer);
+                case JSONPrimitiveType::UNSIGNED:
+                    return JSON(this->node->unsignedInteger);
+                case JSONPrimitiveType::REAL:
+                    return JSON(this->node->real);
+                default: {
+                    std::string_view txt = this->text();
+                    return JSON::rawPrimitive(txt.data(), txt.size());
+                }
+            }
+        case JSONType::STRING: {
+            std::string_view txt = this->text();
+            return JSON(txt.data(), txt.size());
+        }
+        case JSONType::VECTOR: {
+            iterator first = this->begin(), last = this->end();
+            if (first.position == nullptr) {
+                return JSON();
+            }
+            JSON result(JSONType::VECTOR);
+            result.vector->reserve(this->node->size);
+            for (iterator itr = first; itr != last; ++itr) {
+                result.vector->emplace_back((*itr).toJSON());
+            }
+            return result;
+        }
+        case JSONType::OBJECT: {
+            iterator first = this->begin(), last = this->end();
+            if (first.position == nullptr) {
+                return JSON();
+            }
+            JSON result(JSONType::OBJECT);
+            result.object->reserve(this->node->size);
+            for (iterator itr = first; itr != last; ++itr) {
+                result.object->append(itr.key()) = (*itr).toJSON();
+            }
+            result.object->finish();
+            return result;
+        }
+        default:
+            return JSON();
+    }
+}
+
+void JSONView::checkType(JSONType type) const {
+    if (type != this->type()) {
+        JSONError(
+                "Wrong JSON type check. Expected: " + JSONTypeToString(type) +
+                " but have " + JSONTypeToString(this->type())
+        );
+    }
+}
+
+const char* JSONView::at(unsigned long long offset, size_t bytes) const {
+    // a corrupted snapshot must not send a read outside of it
+    if (offset > this->limit or bytes > this->limit - offset) {
+        JSONError("Snapshot is corrupted: offset " + std::to_string(offset) + " is out of bounds");
+        return nullptr;
+    }
+    return this->base + offset;
+}
+
+const char* JSONView::children(size_t bytes) const {
+    // the writer puts the children of a node after it, so following them cannot loop
+    unsigned long long position = (const char*)this->node - this->base;
+    if (this->node->offset <= position or this->node->offset % alignof(SnapshotNode) != 0) {
+        JSONError("Snapshot is corrupted: node at " + std::to_string(position) + " has a bad offset");
+        return nullptr;
+    }
+    return this->at(this->node->offset, bytes);
+}
+
+const SnapshotNode* JSONView::find(std::string_view key) const {
+    if (this->type() != JSONType::OBJECT) {
+        return nullptr;
+    }
+
+    const size_t size = this->node->size;
+    const uint32_t hash = HashKey(key.data(), key.size());
+    const bool indexed = size > JSONObject::kLinearScanLimit;
+    const size_t capacity = indexed ? IndexCapacity(size) : 0;
+    const char *block = this->children(size * sizeof(SnapshotEntry) + capacity * sizeof(SnapshotSlot));
+    if (block == nullptr) {
+        return nullptr;
+    }
+
+    const SnapshotEntry *entries = (const SnapshotEntry*)block;
+    auto Matches = [&](const SnapshotEntry &entry) {
+        if (entry.hash != hash or entry.keySize != key.size()) {
+            return false;
+        }
+        const char *bytes = this->at(entry.keyOffset, entry.keySize);
+        return bytes != nullptr and memcmp(bytes, key.data(), key.size()) == 0;
+    };
+
+    if (not indexed) {
+        for (size_t i = 0; i < size; i += 1) {
+            if (Matches(entries[i])) {
+                return &entries[i].value;
+            }
+        }
+        return nullptr;
+    }
+
+    const SnapshotSlot *index = (const SnapshotSlot*)(entries + size);
+    const size_t mask = capacity - 1;
+    for (size_t i = hash & mask, probes = 0; probes < capacity; i = (i + 1) & mask, probes += 1) {
+        const SnapshotSlot &slot = index[i];
+        if (slot.position == 0 or slot.position > size) {
+            return nullptr;
+        }
+        if (slot.hash == hash and Matches(entries[slot.position - 1])) {
+            return &entries[slot.position - 1].value;
+        }
+    }
+    return nullptr;
+}
+
+/// JSONSnapshot
+
+JSONSnapshot::~JSONSnapshot() {
+    this->close();
+}
+
+void JSONSnapshot::write(const JSON &value, std::string &output) {
+    SnapshotWriter writer(output);
+    writer.write(value);
+}
+
+std::string JSONSnapshot::write(const JSON &value) {
+    std::string output;
+    JSONSnapshot::write(value, output);
+    return output;
+}
+
+bool JSONSnapshot::writeToFile(const JSON &value, const std::string &file_name) {
+    std::string content = JSONSnapshot::write(value);
+
+    std::string temporaryFile = file_name + ".tmp";
+    std::ofstream fout(temporaryFile, std::ios::out | std::ios::binary);
+    fout.write(content.data(), content.size());
+    fout.close();
+
+    if (not fout or rename(temporaryFile.c_str(), file_name.c_str()) != 0) {
+        JSONError("Error while writing " + file_name);
+        remove(temporaryFile.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool JSONSnapshot::open(const std::string &file_name) {
+    this->close();
+
+    int fd = ::open(file_name.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        JSONError("Cannot open " + file_name + ": " + strerror(errno));
+        return false;
+    }
+
+    struct stat status;
+    void *mapping = MAP_FAILED;
+    if (fstat(fd, &status) == 0 and status.st_size > 0) {
+        // shared, so every process that maps the file reads the same pages of the page cache
+        mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+
+    if (mapping == MAP_FAILED) {
+        JSONError("Cannot map " + file_name);
+        return false;
+    }
+
+    this->content = (const char*)mapping;
+    this->contentSize = status.st_size;
+    this->mapped = true;
+    if (not this->check()) {
+        this->close();
+        return false;
+    }
+    return true;
+}
+
+bool JSONSnapshot::open(const char *data, size_t size) {
+    this->close();
+    this->content = data;
+    this->contentSize = size;
+    if (not this->check()) {
+        this->close();
+        return false;
+    }
+    return true;
+}
+
+void JSONSnapshot::close() {
+    if (this->mapped) {
+        munmap((void*)this->content, this->contentSize);
+    }
+    this->content = nullptr;
+    this->contentSize = 0;
+    this->mapped = false;
+}
+
+JSONView JSONSnapshot::root() const {
+    if (this->content == nullptr) {
+        return JSONView();
+    }
+    const SnapshotHeader *header = (const SnapshotHeader*)this->content;
+    return JSONView(this->content, this->contentSize, &header->root);
+}
+
+bool JSONSnapshot::check() {
+    const SnapshotHeader *header = (const SnapshotHeader*)this->content;
+    if (this->contentSize < sizeof(SnapshotHeader) or memcmp(header->magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0) {
+        JSONError("Not a snapshot");
+    } else if (header->version != kSnapshotVersion or header->byteOrder != kByteOrderMark) {
+        JSONError("Snapshot was written by another version or on a machine with another byte order");
+    } else if (header->size != this->contentSize) {
+        JSONError("Snapshot is truncated");
+    } else if ((uintptr_t)this->content % alignof(SnapshotNode) != 0) {
+        JSONError("Snapshot must be 8-byte aligned");
+    } else {
+        return true;
+    }
+    return false;
+}
+
+/// JSONFrozen
+
+JSONFrozen::JSONFrozen(const JSON &value) {
+    // the block is allocated on the heap, which aligns it for the nodes
+    auto content = std::make_shared<std::string>();
+    JSONSnapshot::write(value, *content);
+    this->content = std::move(content);
+}
+
+JSONView JSONFrozen::root() const {
+    if (this->content == nullptr) {
+        return JSONView();
+    }
+    const SnapshotHeader *header = (const SnapshotHeader*)this->content->data();
+    return JSONView(this->content->data(), this->content->size(), &header->root);
+}
+
+JSONFrozen JSON::freeze() const {
+    return JSONFrozen(*this);
+}
+
+}  // namespace autojson
@@ -0,0 +1,208 @@
+#include "Stats.hpp"
+
+#include <string>
+
+#include "Instrument.hpp"
+
+#ifdef AUTOJSON_STATS
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#endif
+
+namespace autojson {
+
+namespace {
+
+const char *kCounterNames[COUNTER_COUNT] = {
+    "nodesAllocated",
+    "nodesFreed",
+    "bytesParsed",
+    "bytesEmitted",
+    "numberConversions",
+    "keyLookups",
+    "keyMisses",
+    "deepCopies"
+};
+
+const char *kTimerNames[TIMER_COUNT] = {
+    "parse",
+    "stringify"
+};
+
+#ifdef AUTOJSON_STATS
+
+using internal::kLatencyBuckets;
+using internal::ThreadStats;
+
+struct Totals {
+    unsigned long long counters[COUNTER_COUNT] = {};
+    unsigned long long timerCounts[TIMER_COUNT] = {};
+    unsigned long long timerTotals[TIMER_COUNT] = {};
+    unsigned long long buckets[TIMER_COUNT][kLatencyBuckets] = {};
+
+    void add(const ThreadStats &stats) {
+        for (int i = 0; i < COUNTER_COUNT; i += 1) {
+            this->counters[i] += stats.counters[i].load(std::memory_order_relaxed);
+        }
+        for (int i = 0; i < TIMER_COUNT; i += 1) {
+            this->timerCounts[i] += stats.timerCounts[i].load(std::memory_order_relaxed);
+            this->timerTotals[i] += stats.timerTotals[i].load(std::memory_order_relaxed);
+            for (int j = 0; j < kLatencyBuckets; j += 1) {
+                this->buckets[i][j] += stats.buckets[i][j].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void subtract(const Totals &rhs) {
+        for (int i = 0; i < COUNTER_COUNT; i += 1) {
+            this->counters[i] -= rhs.counters[i];
+        }
+        for (int i = 0; i < TIMER_COUNT; i += 1) {
+            this->timerCounts[i] -= rhs.timerCounts[i];
+            this->timerTotals[i] -= rhs.timerTotals[i];
+            for (int j = 0; j < kLatencyBuckets; j += 1) {
+                this->buckets[i][j] -= rhs.buckets[i][j];
+            }
+        }
+    }
+};
+
+// The counts of every thread that is alive, and the sums of those that ended
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadStats*> threads;
+    Totals ended;
+    // what ResetStats() saw, taken away from every sum after it; resetting never writes to
+    // the counts of the threads, so it does not race with them
+    Totals baseline;
+
+    Totals sum() {
+        Totals totals = this->ended;
+        for (const ThreadStats *stats : this->threads) {
+            totals.add(*stats);
+        }
+        return totals;
+    }
+};
+
+Registry& GetRegistry() {
+    // never destroyed: threads that end after main still unregister
+    static Registry *registry = new Registry;
+    return *registry;
+}
+
+#endif
+
+}  // namespace
+
+#ifdef AUTOJSON_STATS
+
+namespace internal {
+
+ThreadStats::ThreadStats() {
+    for (auto &itr : this->counters) {
+        itr.store(0, std::memory_order_relaxed);
+    }
+    for (int i = 0; i < TIMER_COUNT; i += 1) {
+        this->timerCounts[i].store(0, std::memory_order_relaxed);
+        this->timerTotals[i].store(0, std::memory_order_relaxed);
+        for (auto &itr : this->buckets[i]) {
+            itr.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    Registry &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.threads.push_back(this);
+}
+
+ThreadStats::~ThreadStats() {
+    Registry &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.ended.add(*this);
+    registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), this));
+}
+
+void RecordLatency(JSONTimer timer, unsigned long long nanoseconds) {
+    // bucket i holds the latencies below 2^i ns
+    int bucket = nanoseconds != 0 ? 64 - __builtin_clzll(nanoseconds) : 0;
+    ThreadStats &stats = LocalStats();
+    Add(stats.timerCounts[timer], 1);
+    Add(stats.timerTotals[timer], nanoseconds);
+    Add(stats.buckets[timer][std::min(bucket, kLatencyBuckets - 1)], 1);
+}
+
+}  // namespace internal
+
+bool StatsEnabled() {
+    return true;
+}
+
+JSON GetStats() {
+    Registry &registry = GetRegistry();
+    Totals totals;
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        totals = registry.sum();
+        totals.subtract(registry.baseline);
+    }
+
+    JSON result;
+    JSON &counters = result["counters"];
+    for (int i = 0; i < COUNTER_COUNT; i += 1) {
+        counters[kCounterNames[i]] = totals.counters[i];
+    }
+
+    JSON &latency = result["latency"];
+    for (int i = 0; i < TIMER_COUNT; i += 1) {
+        JSON &timer = latency[kTimerNames[i]];
+        timer["count"] = totals.timerCounts[i];
+        timer["totalNs"] = totals.timerTotals[i];
+        JSON &buckets = timer["buckets"];
+        buckets = JSON(JSONType::OBJECT);
+        for (int j = 0; j < kLatencyBuckets; j += 1) {
+            if (totals.buckets[i][j] != 0) {
+                buckets[std::to_string(1ULL << j)] = totals.buckets[i][j];
+            }
+        }
+    }
+    return result;
+}
+
+void ResetStats() {
+    Registry &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.baseline = registry.sum();
+}
+
+#else
+
+bool StatsEnabled() {
+    return false;
+}
+
+JSON GetStats() {
+    // same shape, so scrapers do not need to know how the library was built
+    JSON result;
+    JSON &counters = result["counters"];
+    for (int i = 0; i < COUNTER_COUNT; i += 1) {
+        counters[kCounterNames[i]] = 0;
+    }
+
+    JSON &latency = result["latency"];
+    for (int i = 0; i < TIMER_COUNT; i += 1) {
+        JSON &timer = latency[kTimerNames[i]];
+        timer["count"] = 0;
+        timer["totalNs"] = 0;
+        timer["buckets"] = JSON(JSONType::OBJECT);
+    }
+    return result;
+}
+
+void ResetStats() {
+}
+
+#endif
+
+}  // namespace autojson
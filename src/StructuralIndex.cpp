@@ -0,0 +1,255 @@
+#include "StructuralIndex.hpp"
+
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define AUTOJSON_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace autojson {
+
+namespace {
+
+// One bit per byte of a 64 byte block, for each character class the index needs
+struct BlockMasks {
+    uint64_t backslash;
+    uint64_t quote;
+    uint64_t structural;
+    uint64_t whitespace;
+};
+
+typedef void (*ClassifyFunction)(const char *block, BlockMasks &masks);
+
+void ClassifyScalar(const char *block, BlockMasks &masks) {
+    masks = {0, 0, 0, 0};
+    for (int i = 0; i < 64; i += 1) {
+        uint64_t bit = 1ULL << i;
+        switch (block[i]) {
+            case '\\':
+                masks.backslash |= bit;
+                break;
+            case '\"':
+            case '\'':
+                masks.quote |= bit;
+                break;
+            case '{':
+            case '}':
+            case '[':
+            case ']':
+            case ':':
+                masks.structural |= bit;
+                break;
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+            case ',':
+                masks.whitespace |= bit;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+#ifdef AUTOJSON_X86_KERNELS
+
+// PCMPESTRM matches every byte of the block against a whole set of characters at once
+__attribute__((target("sse4.2")))
+uint64_t MatchAnySSE42(const char *block, __m128i set, int setSize) {
+    const int mode = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK;
+    uint64_t result = 0;
+    for (int i = 0; i < 4; i += 1) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(block + 16 * i));
+        uint64_t bits = (uint16_t)_mm_cvtsi128_si32(_mm_cmpestrm(set, setSize, chunk, 16, mode));
+        result |= bits << (16 * i);
+    }
+    return result;
+}
+
+__attribute__((target("sse4.2")))
+void ClassifySSE42(const char *block, BlockMasks &masks) {
+    const __m128i backslash = _mm_setr_epi8('\\', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i quote = _mm_setr_epi8('\"', '\'', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i structural = _mm_setr_epi8('{', '}', '[', ']', ':', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i whitespace = _mm_setr_epi8(' ', '\t', '\n', '\r', ',', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+    masks.backslash = MatchAnySSE42(block, backslash, 1);
+    masks.quote = MatchAnySSE42(block, quote, 2);
+    masks.structural = MatchAnySSE42(block, structural, 5);
+    masks.whitespace = MatchAnySSE42(block, whitespace, 5);
+}
+
+__attribute__((target("avx2")))
+uint64_t MatchAnyAVX2(__m256i low, __m256i high, const char *set, int setSize) {
+    __m256i lowMatch = _mm256_setzero_si256();
+    __m256i highMatch = _mm256_setzero_si256();
+    for (int i = 0; i < setSize; i += 1) {
+        __m256i value = _mm256_set1_epi8(set[i]);
+        lowMatch = _mm256_or_si256(lowMatch, _mm256_cmpeq_epi8(low, value));
+        highMatch = _mm256_or_si256(highMatch, _mm256_cmpeq_epi8(high, value));
+    }
+
+    uint64_t lowBits = (uint32_t)_mm256_movemask_epi8(lowMatch);
+    uint64_t highBits = (uint32_t)_mm256_movemask_epi8(highMatch);
+    return lowBits | (highBits << 32);
+}
+
+__attribute__((target("avx2")))
+void ClassifyAVX2(const char *block, BlockMasks &masks) {
+    __m256i low = _mm256_loadu_si256((const __m256i*)block);
+    __m256i high = _mm256_loadu_si256((const __m256i*)(block + 32));
+
+    masks.backslash = MatchAnyAVX2(low, high, "\\", 1);
+    masks.quote = MatchAnyAVX2(low, high, "\"'", 2);
+    masks.structural = MatchAnyAVX2(low, high, "{}[]:", 5);
+    masks.whitespace = MatchAnyAVX2(low, high, " \t\n\r,", 5);
+}
+
+#endif // AUTOJSON_X86_KERNELS
+
+ClassifyFunction KernelFunction(StructuralKernel kernel) {
+#ifdef AUTOJSON_X86_KERNELS
+    if (kernel == AVX2_KERNEL) {
+        return ClassifyAVX2;
+    }
+    if (kernel == SSE42_KERNEL) {
+        return ClassifySSE42;
+    }
+#endif
+    return ClassifyScalar;
+}
+
+// Bit i of the result is the xor of bits 0..i: set for every byte between an opening and a closing quote
+uint64_t PrefixXor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+// Carries the string / escape / word state from one block to the next
+class BlockScanner {
+public:
+    // Offsets of the interesting characters of the block
+    uint64_t next(const BlockMasks &masks) {
+        uint64_t escaped = this->escapedCharacters(masks.backslash);
+        uint64_t quotes = masks.quote & ~escaped;
+
+        uint64_t inString = PrefixXor(quotes) ^ this->previousInString;
+        this->previousInString = (uint64_t)((int64_t)inString >> 63);
+
+        uint64_t structural = masks.structural & ~inString;
+
+        // a bare word starts on any other character outside of strings that follows a delimiter
+        uint64_t delimiters = masks.structural | masks.whitespace | quotes;
+        uint64_t other = ~(delimiters | inString);
+        uint64_t wordStarts = other & ((delimiters << 1) | this->previousDelimiter);
+        this->previousDelimiter = delimiters >> 63;
+
+        return quotes | structural | wordStarts;
+    }
+
+private:
+    uint64_t nextIsEscaped = 0;
+    uint64_t previousInString = 0;
+    uint64_t previousDelimiter = 1;
+
+    // Characters preceded by an odd number of backslashes
+    uint64_t escapedCharacters(uint64_t backslash) {
+        const uint64_t oddBits = 0xAAAAAAAAAAAAAAAAULL;
+
+        if (backslash == 0) {
+            uint64_t escaped = this->nextIsEscaped;
+            this->nextIsEscaped = 0;
+            return escaped;
+        }
+
+        // A backslash escaped by the previous block does not escape anything itself.
+        // Subtracting a run of backslashes from the odd bits turns every escaping backslash
+        // and every escaped character of that run into a 1.
+        uint64_t potentialEscape = backslash & ~this->nextIsEscaped;
+        uint64_t maybeEscaped = potentialEscape << 1;
+        uint64_t escapeAndTerminal = ((maybeEscaped | oddBits) - potentialEscape) ^ oddBits;
+        uint64_t escaped = escapeAndTerminal ^ (backslash | this->nextIsEscaped);
+        uint64_t escape = escapeAndTerminal & backslash;
+        this->nextIsEscaped = escape >> 63;
+        return escaped;
+    }
+};
+
+void AppendOffsets(uint64_t bits, uint32_t base, std::vector<uint32_t> &index) {
+    if (bits == 0) {
+        return;
+    }
+
+    size_t start = index.size();
+    index.resize(start + __builtin_popcountll(bits));
+    uint32_t *out = index.data() + start;
+    while (bits) {
+        *out++ = base + __builtin_ctzll(bits);
+        bits &= bits - 1;
+    }
+}
+
+}  // namespace
+
+const char* StructuralKernelToString(StructuralKernel kernel) {
+    switch (kernel) {
+        case AUTO_KERNEL:       return "auto";
+        case SCALAR_KERNEL:     return "scalar";
+        case SSE42_KERNEL:      return "sse4.2";
+        case AVX2_KERNEL:       return "avx2";
+        default:                return "unknown";
+    }
+}
+
+StructuralKernel DetectStructuralKernel() {
+#ifdef AUTOJSON_X86_KERNELS
+    static const StructuralKernel best = []() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return AVX2_KERNEL;
+        }
+        if (__builtin_cpu_supports("sse4.2")) {
+            return SSE42_KERNEL;
+        }
+        return SCALAR_KERNEL;
+    }();
+    return best;
+#else
+    return SCALAR_KERNEL;
+#endif
+}
+
+void BuildStructuralIndex(const char *content, size_t size, std::vector<uint32_t> &index, StructuralKernel kernel) {
+    if (kernel == AUTO_KERNEL) {
+        kernel = DetectStructuralKernel();
+    }
+    ClassifyFunction classify = KernelFunction(kernel);
+
+    BlockScanner scanner;
+    BlockMasks masks;
+
+    size_t offset = 0;
+    for (; offset + 64 <= size; offset += 64) {
+        classify(content + offset, masks);
+        AppendOffsets(scanner.next(masks), (uint32_t)offset, index);
+    }
+
+    if (offset < size) {
+        // whitespace padding does not change the meaning of the tail
+        char tail[64];
+        memset(tail, ' ', sizeof(tail));
+        memcpy(tail, content + offset, size - offset);
+        classify(tail, masks);
+        uint64_t valid = (1ULL << (size - offset)) - 1;
+        AppendOffsets(scanner.next(masks) & valid, (uint32_t)offset, index);
+    }
+}
+
+}  // namespace autojson
@@ -0,0 +1,39 @@
+#ifndef AUTOJSON_STRUCTURAL_INDEX_HPP
+#define AUTOJSON_STRUCTURAL_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace autojson {
+
+// Character classification kernels for the structural index.
+// AUTO_KERNEL picks the best one the CPU supports at runtime.
+enum StructuralKernel {
+    AUTO_KERNEL,
+    SCALAR_KERNEL,
+    SSE42_KERNEL,
+    AVX2_KERNEL
+};
+
+const char* StructuralKernelToString(StructuralKernel kernel);
+
+// Best kernel available on this machine
+StructuralKernel DetectStructuralKernel();
+
+// Finds, in one pass over content, the offset of every
+//  - unescaped quote (both the opening and the closing one of each string)
+//  - { } [ ] : outside of strings
+//  - first character of a bare word (number, literal) outside of strings
+// Like the classic parser, ' and " both delimit strings and commas count as whitespace.
+// The offsets are appended to index in increasing order. content must be shorter than 4GB.
+void BuildStructuralIndex(const char *content, size_t size, std::vector<uint32_t> &index,
+                          StructuralKernel kernel = AUTO_KERNEL);
+
+}  // namespace autojson
+
+#ifndef autojsonuselib
+#include "autojson_src/StructuralIndex.cpp"
+#endif
+
+#endif // AUTOJSON_STRUCTURAL_INDEX_HPP
@@ -0,0 +1,241 @@
+#include "Writer.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+#include "Error.hpp"
+#include "JSON.hpp"
+#include "Format.hpp"
+#include "Instrument.hpp"
+
+namespace autojson {
+
+void StreamSink::write(const char *data, size_t size) {
+    this->os.write(data, size);
+}
+
+void FileDescriptorSink::write(const char *data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(this->fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            JSONError("Cannot write to file descriptor " + std::to_string(this->fd) + ": " + strerror(errno));
+            return;
+        }
+        data += written;
+        size -= written;
+    }
+}
+
+JSONWriter::JSONWriter(std::string &output, bool shrink)
+    : out(output), sink(nullptr), shrink(shrink), depth(0), needComma(false), afterKey(false) {
+}
+
+JSONWriter::JSONWriter(JSONSink &sink, bool shrink)
+    : out(ownBuffer), sink(&sink), shrink(shrink), depth(0), needComma(false), afterKey(false) {
+    this->ownBuffer.reserve(kFlushSize + kFlushSize / 4);
+}
+
+JSONWriter::~JSONWriter() {
+    this->flush();
+}
+
+void JSONWriter::flush() {
+    if (this->sink != nullptr and not this->out.empty()) {
+        AUTOJSON_COUNT(BYTES_EMITTED, this->out.size());
+        this->sink->write(this->out.data(), this->out.size());
+        this->out.clear();
+    }
+}
+
+void JSONWriter::write(const JSON &value) {
+    switch (value.type) {
+        case JSONType::PRIMITIVE:
+            switch (value.primitiveType()) {
+                case JSONPrimitiveType::NULL_VALUE:
+                    this->null();
+                    break;
+                case JSONPrimitiveType::BOOLEAN:
+                    this->boolean(value.boolean);
+                    break;
+                case JSONPrimitiveType::INTEGER:
+                    this->integer(value.integer);
+                    break;
+                case JSONPrimitiveType::UNSIGNED:
+                    this->unsignedInteger(value.unsignedInteger);
+                    break;
+                case JSONPrimitiveType::REAL:
+                    this->real(value.real);
+                    break;
+                default:
+                    this->raw(value.textData(), value.textSize());
+            }
+            break;
+        case JSONType::STRING:
+            this->string(value.textData(), value.textSize());
+            break;
+        case JSONType::VECTOR:
+            this->startArray();
+            for (const JSON &itr : *value.vector) {
+                this->write(itr);
+            }
+            this->endArray();
+            break;
+        case JSONType::OBJECT:
+            this->startObject();
+            for (const auto &itr : *value.object) {
+                this->key(itr.keyData, itr.keySize);
+                this->write(itr.value);
+            }
+            this->endObject();
+            break;
+        default:
+            JSONError("Cannot Stringify an invalid JSON");
+    }
+}
+
+void JSONWriter::startObject() {
+    this->beginValue();
+    this->out += '{';
+    this->depth += 1;
+    this->needComma = false;
+}
+
+void JSONWriter::key(const char *data, size_t size) {
+    this->beginValue();
+    this->out += '\"';
+    this->escaped(data, size);
+    this->out += "\":";
+    this->afterKey = true;
+}
+
+void JSONWriter::escapedKey(const char *data, size_t size) {
+    this->beginValue();
+    this->out += '\"';
+    this->out.append(data, size);
+    this->out += "\":";
+    this->afterKey = true;
+}
+
+void JSONWriter::endObject() {
+    this->depth -= 1;
+    this->newLine(this->depth);
+    this->out += '}';
+    this->endValue();
+}
+
+void JSONWriter::startArray() {
+    this->beginValue();
+    this->out += '[';
+    this->depth += 1;
+    this->needComma = false;
+}
+
+void JSONWriter::endArray() {
+    this->depth -= 1;
+    this->newLine(this->depth);
+    this->out += ']';
+    this->endValue();
+}
+
+void JSONWriter::string(const char *data, size_t size) {
+    this->beginValue();
+    this->out += '\"';
+    this->escaped(data, size);
+    this->out += '\"';
+    this->endValue();
+}
+
+void JSONWriter::null() {
+    this->raw("null", 4);
+}
+
+void JSONWriter::boolean(bool value) {
+    if (value) {
+        this->raw("true", 4);
+    } else {
+        this->raw("false", 5);
+    }
+}
+
+void JSONWriter::integer(long long value) {
+    char buffer[kMaxNumberLength];
+    this->raw(buffer, FormatInteger(value, buffer));
+}
+
+void JSONWriter::unsignedInteger(unsigned long long value) {
+    char buffer[kMaxNumberLength];
+    this->raw(buffer, FormatUnsigned(value, buffer));
+}
+
+void JSONWriter::real(double value) {
+    char buffer[kMaxNumberLength];
+    this->raw(buffer, FormatReal(value, buffer));
+}
+
+void JSONWriter::raw(const char *data, size_t size) {
+    this->beginValue();
+    this->out.append(data, size);
+    this->endValue();
+}
+
+void JSONWriter::beginValue() {
+    if (this->afterKey) {
+        this->afterKey = false;
+        return;
+    }
+    if (this->depth == 0) {
+        return;
+    }
+
+    if (this->needComma) {
+        this->out += ',';
+    }
+    this->newLine(this->depth);
+}
+
+void JSONWriter::endValue() {
+    this->needComma = true;
+    if (this->sink != nullptr and this->out.size() >= kFlushSize) {
+        this->flush();
+    }
+}
+
+void JSONWriter::newLine(int indentLevel) {
+    if (this->shrink) {
+        return;
+    }
+
+    static const char spaces[] = "                                                                ";
+    this->out += '\n';
+    for (size_t left = indentLevel * 4; left > 0; ) {
+        size_t chunk = left < sizeof(spaces) - 1 ? left : sizeof(spaces) - 1;
+        this->out.append(spaces, chunk);
+        left -= chunk;
+    }
+}
+
+// Same escaping as EscapeKeys, appended run by run instead of char by char
+void JSONWriter::escaped(const char *data, size_t size) {
+    const char *end = data + size;
+    const char *run = data;
+    for (const char *p = data; p != end; p++) {
+        const char *replacement;
+        switch (*p) {
+            case '\"': replacement = "\\\""; break;
+            case '\n': replacement = "\\n"; break;
+            case '\r': replacement = "\\r"; break;
+            case '\t': replacement = "\\t"; break;
+            default: continue;
+        }
+        this->out.append(run, p);
+        this->out.append(replacement, 2);
+        run = p + 1;
+    }
+    this->out.append(run, end);
+}
+
+}  // namespace autojson